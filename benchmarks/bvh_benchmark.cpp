@@ -0,0 +1,207 @@
+//BVH scene: vreme izgradnje i refit-a, frustum, ray i radius upiti u poredjenju sa linearnim prolazom
+//pokretanje: ./bvh_benchmark [broj instanci...], podrazumevano 10000 100000 1000000
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <rg/Bounds.h>
+#include <rg/Bvh.h>
+#include <rg/CullKernel.h>
+#include <rg/Frustum.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+//ponavlja fn dok ne prodje bar 100 ms i vraca najbolje vreme jednog prolaza u nanosekundama
+template <typename F>
+double measure(F fn) {
+    double best = 1e300;
+    double total = 0.0;
+    int runs = 0;
+    while (total < 100.0e6 || runs < 3) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed);
+        total += elapsed;
+        runs++;
+    }
+    return best;
+}
+
+void report(const char* name, double bvh_ns, double linear_ns, size_t result) {
+    std::cout << "  " << std::left << std::setw(16) << name << std::right << std::fixed
+              << std::setw(12) << std::setprecision(1) << bvh_ns / 1.0e3 << " us BVH"
+              << std::setw(12) << linear_ns / 1.0e3 << " us linearno"
+              << std::setw(9) << std::setprecision(1) << linear_ns / bvh_ns << "x"
+              << "   rezultat " << result << "\n";
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> counts;
+    for (int i = 1; i < argc; i++) {
+        counts.push_back((size_t) std::strtoul(argv[i], nullptr, 10));
+    }
+    if (counts.empty()) {
+        counts = {10000, 100000, 1000000};
+    }
+
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+    for (size_t count : counts) {
+        //instance rasute po terenu cija povrsina raste sa brojem instanci, kao vegetacija
+        float half_size = std::sqrt((float) count) * 2.0f;
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> position(-half_size, half_size);
+        std::uniform_real_distribution<float> height(0.0f, 4.0f);
+        std::uniform_real_distribution<float> size(0.25f, 2.0f);
+
+        std::vector<rg::AABB> boxes(count);
+        for (rg::AABB& box : boxes) {
+            glm::vec3 center(position(random), height(random), position(random));
+            glm::vec3 extents(size(random), size(random) * 2.0f, size(random));
+            box.extend(center - extents);
+            box.extend(center + extents);
+        }
+
+        std::cout << count << " instanci\n";
+        rg::Bvh bvh;
+        double build_ns = measure([&] { bvh.build(boxes); });
+        std::cout << "  izgradnja " << std::fixed << std::setprecision(2) << build_ns / 1.0e6 << " ms, "
+                  << bvh.nodeCount() << " cvorova\n";
+
+        //pomeranje 1% instanci: refit celog stabla i osvezavanje puteva pojedinacnih instanci
+        std::vector<rg::AABB> moved = boxes;
+        size_t moved_count = std::max<size_t>(1, count / 100);
+        for (size_t i = 0; i < moved_count; i++) {
+            size_t index = i * 100 % count;
+            moved[index].m_min += glm::vec3(0.5f, 0.0f, 0.0f);
+            moved[index].m_max += glm::vec3(0.5f, 0.0f, 0.0f);
+        }
+        double refit_ns = measure([&] { bvh.refit(moved); });
+        double update_ns = measure([&] {
+            for (size_t i = 0; i < moved_count; i++) {
+                size_t index = i * 100 % count;
+                bvh.update((uint32_t) index, moved[index]);
+            }
+        });
+        std::cout << "  refit " << refit_ns / 1.0e6 << " ms, update " << moved_count << " instanci "
+                  << update_ns / 1.0e6 << " ms\n";
+        bvh.refit(boxes);
+
+        //frustum sa kamerom u sredini terena
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(1.0f, 2.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        rg::Frustum frustum = rg::Frustum::fromMatrix(projection * view);
+
+        std::vector<uint8_t> reference(count), found(count);
+        size_t bvh_visible = 0, linear_visible = 0;
+        double frustum_bvh = measure([&] {
+            bvh_visible = 0;
+            bvh.queryFrustum(frustum, [&](uint32_t item) {
+                found[item] = 1;
+                bvh_visible++;
+            });
+        });
+        double frustum_linear = measure([&] {
+            linear_visible = 0;
+            for (size_t i = 0; i < count; i++) {
+                reference[i] = frustum.intersects(boxes[i]) ? 1 : 0;
+                linear_visible += reference[i];
+            }
+        });
+        report("frustum", frustum_bvh, frustum_linear, bvh_visible);
+
+        rg::BoundsStore store;
+        store.reserve(count);
+        for (const rg::AABB& box : boxes) {
+            rg::Sphere sphere;
+            sphere.m_center = box.center();
+            sphere.m_radius = glm::length(box.extents());
+            store.add(box, sphere);
+        }
+        std::vector<uint8_t> kernel_visible(count);
+        double frustum_kernel = measure([&] { rg::cullBoxes(store, frustum, kernel_visible.data()); });
+        report("frustum SoA", frustum_bvh, frustum_kernel, bvh_visible);
+
+        if (bvh_visible != linear_visible || found != reference) {
+            std::cerr << "ERROR::BVH_BENCHMARK::FRUSTUM " << bvh_visible << " != " << linear_visible << "\n";
+            return 1;
+        }
+
+        //zraci iz nasumicnih tacaka iznad terena u nasumicnim smerovima nadole
+        const int ray_count = 100;
+        std::vector<glm::vec3> origins(ray_count), directions(ray_count);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        for (int i = 0; i < ray_count; i++) {
+            origins[i] = glm::vec3(position(random), 10.0f, position(random));
+            directions[i] = glm::normalize(glm::vec3(unit(random), -0.2f - std::abs(unit(random)), unit(random)));
+        }
+        const float ray_length = 1000.0f;
+        std::vector<int> bvh_hits(ray_count), linear_hits(ray_count);
+        std::vector<float> bvh_distances(ray_count), linear_distances(ray_count);
+        size_t hit_count = 0;
+        double ray_bvh = measure([&] {
+            hit_count = 0;
+            for (int i = 0; i < ray_count; i++) {
+                bvh_hits[i] = bvh.raycast(origins[i], directions[i], ray_length, bvh_distances[i]);
+                hit_count += bvh_hits[i] >= 0;
+            }
+        });
+        double ray_linear = measure([&] {
+            for (int i = 0; i < ray_count; i++) {
+                glm::vec3 inverse = 1.0f / directions[i];
+                linear_hits[i] = -1;
+                linear_distances[i] = ray_length;
+                for (size_t j = 0; j < count; j++) {
+                    float enter;
+                    if (rg::Bvh::intersectRay(boxes[j], origins[i], inverse, linear_distances[i], enter)
+                        && enter < linear_distances[i]) {
+                        linear_distances[i] = enter;
+                        linear_hits[i] = (int) j;
+                    }
+                }
+            }
+        });
+        report("100 zraka", ray_bvh, ray_linear, hit_count);
+
+        //pogodjena instanca moze da se razlikuje samo kad su dve na istom rastojanju
+        for (int i = 0; i < ray_count; i++) {
+            if ((bvh_hits[i] < 0) != (linear_hits[i] < 0) || bvh_distances[i] != linear_distances[i]) {
+                std::cerr << "ERROR::BVH_BENCHMARK::RAY " << i << "\n";
+                return 1;
+            }
+        }
+
+        //poluprecnik od 10 oko nasumicnih tacaka
+        const int radius_count = 100;
+        const float radius = 10.0f;
+        size_t bvh_found = 0, linear_found = 0;
+        double radius_bvh = measure([&] {
+            bvh_found = 0;
+            for (int i = 0; i < radius_count; i++) {
+                bvh.queryRadius(origins[i], radius, [&](uint32_t) { bvh_found++; });
+            }
+        });
+        double radius_linear = measure([&] {
+            linear_found = 0;
+            for (int i = 0; i < radius_count; i++) {
+                for (size_t j = 0; j < count; j++) {
+                    linear_found += rg::Bvh::distanceSquared(boxes[j], origins[i]) <= radius * radius;
+                }
+            }
+        });
+        report("100 radius", radius_bvh, radius_linear, bvh_found);
+
+        if (bvh_found != linear_found) {
+            std::cerr << "ERROR::BVH_BENCHMARK::RADIUS " << bvh_found << " != " << linear_found << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
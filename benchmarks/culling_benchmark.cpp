@@ -0,0 +1,120 @@
+//poredjenje protoka frustum culling-a: jedan AABB po pozivu (Frustum::intersects) i SoA kerneli
+//pokretanje: ./culling_benchmark [broj objekata...], podrazumevano 1000 10000 100000
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <rg/Bounds.h>
+#include <rg/CullKernel.h>
+#include <rg/Frustum.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+//ponavlja fn dok ne prodje bar 100 ms i vraca najbolje vreme jednog prolaza u nanosekundama
+template <typename F>
+double measure(F fn) {
+    double best = 1e300;
+    double total = 0.0;
+    int runs = 0;
+    while (total < 100.0e6 || runs < 5) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed);
+        total += elapsed;
+        runs++;
+    }
+    return best;
+}
+
+void report(const char* name, size_t count, double nanoseconds, size_t visible, double baseline) {
+    std::cout << "  " << std::left << std::setw(18) << name << std::right
+              << std::setw(9) << std::fixed << std::setprecision(2) << nanoseconds / count << " ns/objekat"
+              << std::setw(10) << std::setprecision(1) << count / nanoseconds * 1.0e3 << " M objekata/s"
+              << std::setw(8) << std::setprecision(2) << baseline / nanoseconds << "x"
+              << "   vidljivo " << visible << "\n";
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> counts;
+    for (int i = 1; i < argc; i++) {
+        counts.push_back((size_t) std::strtoul(argv[i], nullptr, 10));
+    }
+    if (counts.empty()) {
+        counts = {1000, 10000, 100000};
+    }
+
+    //kamera kao u sceni: 45 stepeni, 16:9, daljina 100
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 2.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    rg::Frustum frustum = rg::Frustum::fromMatrix(projection * view);
+
+    std::cout << "najbolji kernel: " << rg::cullKernelName(rg::bestCullKernel()) << "\n";
+
+    for (size_t count : counts) {
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> position(-150.0f, 150.0f);
+        std::uniform_real_distribution<float> size(0.25f, 4.0f);
+
+        std::vector<rg::AABB> boxes(count);
+        rg::BoundsStore store;
+        store.reserve(count);
+        for (rg::AABB& box : boxes) {
+            glm::vec3 center(position(random), position(random) * 0.1f, position(random));
+            glm::vec3 extents(size(random), size(random), size(random));
+            box.extend(center - extents);
+            box.extend(center + extents);
+            rg::Sphere sphere;
+            sphere.m_center = center;
+            sphere.m_radius = glm::length(extents);
+            store.add(box, sphere);
+        }
+
+        std::vector<uint8_t> visible(count), reference(count);
+        std::cout << count << " objekata\n";
+
+        size_t reference_count = 0;
+        double baseline = measure([&] {
+            reference_count = 0;
+            for (size_t i = 0; i < count; i++) {
+                reference[i] = frustum.intersects(boxes[i]) ? 1 : 0;
+                reference_count += reference[i];
+            }
+        });
+        report("AABB po objektu", count, baseline, reference_count, baseline);
+
+        const rg::CullKernel kernels[] = {rg::CullKernel::Scalar, rg::CullKernel::SSE, rg::CullKernel::AVX2};
+        for (rg::CullKernel kernel : kernels) {
+            if (kernel == rg::CullKernel::AVX2 && rg::bestCullKernel() != rg::CullKernel::AVX2) {
+                continue;
+            }
+            if (kernel == rg::CullKernel::SSE && rg::bestCullKernel() == rg::CullKernel::Scalar) {
+                continue;
+            }
+
+            size_t visible_count = 0;
+            double boxes_ns = measure([&] { visible_count = rg::cullBoxes(store, frustum, visible.data(), kernel); });
+            std::string name = std::string("AABB ") + rg::cullKernelName(kernel);
+            report(name.c_str(), count, boxes_ns, visible_count, baseline);
+
+            //SoA kernel mora dati isti rezultat kao test jednog AABB-a
+            for (size_t i = 0; i < count; i++) {
+                if (visible[i] != reference[i]) {
+                    std::cerr << "ERROR::CULLING_BENCHMARK::RAZLIKA " << name << " objekat " << i << "\n";
+                    return 1;
+                }
+            }
+
+            double spheres_ns = measure([&] { visible_count = rg::cullSpheres(store, frustum, visible.data(), kernel); });
+            name = std::string("sfera ") + rg::cullKernelName(kernel);
+            report(name.c_str(), count, spheres_ns, visible_count, baseline);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+//CPU vreme slanja hiljada poziva crtanja kroz RenderQueue: pojedinacni pozivi (GL 3.3 put) i glMultiDrawElementsIndirect
+//treba GL kontekst, pa se otvara skriveni prozor; pokretanje: ./indirect_benchmark [broj poziva...],
+//podrazumevano 1000 5000 20000
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <rg/FrameStats.h>
+#include <rg/GeometryPool.h>
+#include <rg/Mesh.h>
+#include <rg/MultiDrawIndirect.h>
+#include <rg/Placeholder.h>
+#include <rg/RenderQueue.h>
+#include <rg/Shader.h>
+#include <rg/ShaderVariants.h>
+#include <rg/UniformBuffer.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+//broj razlicitih mesh-eva i materijala medju pozivima
+const unsigned int MESH_COUNT = 64;
+const unsigned int MATERIAL_COUNT = 16;
+const int WARMUP_FRAMES = 10;
+const int FRAMES = 100;
+
+struct FrameTimes {
+    double m_push_ms = 0.0;
+    double m_submit_ms = 0.0;
+    double m_frame_ms = 0.0;
+    size_t m_draw_calls = 0;
+};
+
+double millisecondsBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+//prosek po frejmu; glFinish posle submit-a odvaja CPU vreme slanja od vremena na GPU-u
+FrameTimes measure(rg::RenderQueue &queue, Shader &shader, std::vector<Mesh> &meshes, const std::vector<glm::mat4> &models) {
+    FrameTimes times;
+    for (int frame = 0; frame < WARMUP_FRAMES + FRAMES; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        auto start = std::chrono::steady_clock::now();
+        queue.begin(glm::vec3(0.0f));
+        for (size_t i = 0; i < models.size(); i++) {
+            queue.push(shader, meshes[i % meshes.size()], 0, models[i], glm::vec3(models[i][3]));
+        }
+        auto pushed = std::chrono::steady_clock::now();
+        queue.submit();
+        auto submitted = std::chrono::steady_clock::now();
+        glFinish();
+        auto finished = std::chrono::steady_clock::now();
+
+        size_t draw_calls = rg::FrameStats::instance().current().m_draw_calls;
+        rg::FrameStats::instance().endFrame(0.0);
+        if (frame < WARMUP_FRAMES)
+            continue;
+        times.m_push_ms += millisecondsBetween(start, pushed) / FRAMES;
+        times.m_submit_ms += millisecondsBetween(pushed, submitted) / FRAMES;
+        times.m_frame_ms += millisecondsBetween(start, finished) / FRAMES;
+        times.m_draw_calls = draw_calls;
+    }
+    return times;
+}
+
+void report(const char* name, const FrameTimes& times) {
+    std::cout << "  " << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << times.m_push_ms << " ms push" << std::setw(10) << times.m_submit_ms << " ms submit"
+              << std::setw(10) << times.m_frame_ms << " ms do glFinish" << std::setw(8) << times.m_draw_calls
+              << " poziva\n";
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> counts;
+    for (int i = 1; i < argc; i++) {
+        counts.push_back((size_t) std::strtoull(argv[i], nullptr, 10));
+    }
+    if (counts.empty()) {
+        counts = {1000, 5000, 20000};
+    }
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow *window = glfwCreateWindow(256, 256, "indirect_benchmark", NULL, NULL);
+    if (window == NULL) {
+        std::cerr << "ERROR::BENCHMARK::NEUSPESNO_KREIRANJE_PROZORA" << "\n";
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+        std::cerr << "ERROR::BENCHMARK::GLAD" << "\n";
+        glfwTerminate();
+        return 1;
+    }
+
+    bool indirect_supported = rg::MultiDrawIndirect::isSupported();
+    std::cout << "OpenGL " << glGetString(GL_VERSION) << ", " << glGetString(GL_RENDERER) << "\n";
+    if (!indirect_supported) {
+        std::cout << "glMultiDrawElementsIndirect nije podrzan, meri se samo GL 3.3 put\n";
+    }
+    rg::FrameStats::instance().m_report_interval = 1.0e30;
+    glEnable(GL_DEPTH_TEST);
+
+    {
+        rg::ShaderVariants shaders(FileSystem::getPath("resources/shaders/object.vs"),
+                                   FileSystem::getPath("resources/shaders/object.fs"));
+        Shader &object_shader = shaders.get(rg::SHADER_DIRECTIONAL_LIGHT);
+        Shader &instanced_shader = shaders.get(rg::SHADER_DIRECTIONAL_LIGHT | rg::SHADER_INSTANCED);
+
+        rg::UniformBuffer<rg::FrameData> frame_uniforms(rg::FRAME_BLOCK_BINDING);
+        rg::FrameData frame_data;
+        frame_data.m_projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 200.0f);
+        frame_data.m_view = glm::lookAt(glm::vec3(0.0f, 0.0f, 120.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        frame_uniforms.update(frame_data);
+        rg::UniformBuffer<rg::LightData> light_uniforms(rg::LIGHT_BLOCK_BINDING);
+        light_uniforms.update(rg::LightData());
+
+        //male kutije razlicitih velicina; materijali se razlikuju po prefiksu imena sampler-a
+        std::vector<Mesh> meshes;
+        for (unsigned int i = 0; i < MESH_COUNT; i++) {
+            float size = 0.2f + 0.01f * (float) i;
+            rg::AABB bounds;
+            bounds.extend(glm::vec3(-size));
+            bounds.extend(glm::vec3(size));
+            MeshData data = rg::placeholderBox(bounds);
+            meshes.emplace_back(data.m_vertices, data.m_indices, data.m_textures);
+            meshes.back().SetTextureNamePrefix("material" + std::to_string(i % MATERIAL_COUNT) + ".");
+        }
+
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+
+        rg::RenderQueue queue;
+        for (size_t count : counts) {
+            std::vector<glm::mat4> models(count);
+            for (glm::mat4& model : models) {
+                model = glm::translate(glm::mat4(1.0f), glm::vec3(position(random), position(random), position(random)));
+            }
+
+            std::cout << count << " poziva, " << MESH_COUNT << " mesh-eva, " << MATERIAL_COUNT << " materijala\n";
+            queue.m_indirect = false;
+            report("GL 3.3", measure(queue, object_shader, meshes, models));
+            if (indirect_supported) {
+                queue.m_indirect = true;
+                report("indirektno", measure(queue, instanced_shader, meshes, models));
+            }
+        }
+
+        for (Mesh& mesh : meshes) {
+            mesh.Release();
+        }
+        rg::GeometryPool::instance().release();
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
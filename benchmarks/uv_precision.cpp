@@ -0,0 +1,84 @@
+//provera preciznosti UV koordinata u pakovanim formatima verteksa na pravim modelima scene
+//za svaki .obj meri najvecu gresku UV-a posle pakovanja u half float (Packed) i u format koji bi mesh zaista
+//dobio (resolveVertexFormat); vraca 1 ako greska izabranog formata prelazi polovinu koraka half float-a do
+//HALF_UV_LIMIT, tj. ako bi se ponavljana tekstura pomerala
+//pokretanje iz korena projekta: ./uv_precision_check [putanje do .obj...], podrazumevano modeli iz resources/objects
+
+#include <glm/glm.hpp>
+
+#include <rg/VertexLayout.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+const char* formatName(rg::VertexFormat format) {
+    const char* names[] = {"Full", "Packed", "PackedTangent", "PackedWideUv", "PackedTangentWideUv"};
+    return names[(size_t) format];
+}
+
+//UV koordinate iz "vt" linija, obrnute po v kao sa aiProcess_FlipUVs; ostatak verteksa nije bitan za UV
+bool readTextureCoordinates(const std::string& path, std::vector<Vertex>& vertices) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "ERROR::UV_CHECK::NEUSPESNO_UCITAVANJE_FAJLA " << path << "\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.compare(0, 3, "vt ") != 0)
+            continue;
+        std::istringstream values(line.substr(3));
+        Vertex vertex{};
+        float u = 0.0f;
+        float v = 0.0f;
+        values >> u >> v;
+        vertex.m_normal = glm::vec3(0.0f, 1.0f, 0.0f);
+        vertex.m_tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+        vertex.m_bitangent = glm::vec3(0.0f, 0.0f, 1.0f);
+        vertex.m_texture_coordinates = glm::vec2(u, 1.0f - v);
+        vertices.push_back(vertex);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        paths.push_back(argv[i]);
+    }
+    if (paths.empty()) {
+        paths = {"resources/objects/grass/Plane.obj", "resources/objects/tree/Tree.obj", "resources/objects/hut/dom 1.obj"};
+    }
+
+    //half float do HALF_UV_LIMIT = 2 ima korak 1/1024, pa zaokruzivanje gresi najvise pola koraka
+    const float MAX_ERROR = 1.0f / 2048.0f;
+    bool passed = true;
+    for (const std::string& path : paths) {
+        std::vector<Vertex> vertices;
+        if (!readTextureCoordinates(path, vertices)) {
+            passed = false;
+            continue;
+        }
+
+        float largest = 0.0f;
+        for (const Vertex& vertex : vertices) {
+            largest = std::max(largest, std::max(std::fabs(vertex.m_texture_coordinates.x), std::fabs(vertex.m_texture_coordinates.y)));
+        }
+        rg::VertexFormat format = rg::resolveVertexFormat(rg::VertexFormat::Packed, vertices);
+        float half_error = rg::uvRoundTripError(rg::VertexFormat::Packed, vertices);
+        float error = rg::uvRoundTripError(format, vertices);
+        bool ok = error <= MAX_ERROR;
+        passed = passed && ok;
+
+        std::cout << path << ": " << vertices.size() << " UV koordinata, najveca |uv| " << largest
+                  << std::scientific << std::setprecision(2) << ", greska half " << half_error << ", "
+                  << formatName(format) << " " << error << std::defaultfloat << (ok ? "" : " PREVELIKA") << "\n";
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+#ifndef PROJECT_BASE_BLOCKCOMPRESSION_H
+#define PROJECT_BASE_BLOCKCOMPRESSION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace rg {
+
+//softverski koder i dekoder BC1/BC4 blokova (4x4 piksela, 8 bajtova)
+//BC3 = BC4 blok za alfu + BC1 blok za boju, BC5 = dva BC4 bloka (R i G)
+namespace bc {
+
+inline uint16_t packRgb565(const float color[3]) {
+    int r = (int) std::lround(std::min(std::max(color[0], 0.0f), 255.0f) * 31.0f / 255.0f);
+    int g = (int) std::lround(std::min(std::max(color[1], 0.0f), 255.0f) * 63.0f / 255.0f);
+    int b = (int) std::lround(std::min(std::max(color[2], 0.0f), 255.0f) * 31.0f / 255.0f);
+    return (uint16_t) ((r << 11) | (g << 5) | b);
+}
+
+inline void unpackRgb565(uint16_t packed, int color[3]) {
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+//paleta BC1 bloka; u 4-bojnom rezimu (c0 > c1) su dve boje interpolirane, inace jedna plus providna crna
+inline void colorPalette(uint16_t c0, uint16_t c1, bool four_colors, int palette[4][4]) {
+    unpackRgb565(c0, palette[0]);
+    unpackRgb565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = 255;
+    for (int i = 0; i < 3; i++) {
+        if (four_colors) {
+            palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+            palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+        } else {
+            palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+            palette[3][i] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = four_colors ? 255 : 0;
+}
+
+//BC1 blok od 16 RGBA piksela; krajnje boje leze na glavnoj osi rasipanja boja u bloku
+inline void encodeColorBlock(const unsigned char rgba[16 * 4], unsigned char out[8]) {
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    for (int p = 0; p < 16; p++) {
+        for (int i = 0; i < 3; i++) {
+            mean[i] += rgba[p * 4 + i] / 16.0f;
+        }
+    }
+
+    float covariance[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (int p = 0; p < 16; p++) {
+        float r = rgba[p * 4 + 0] - mean[0];
+        float g = rgba[p * 4 + 1] - mean[1];
+        float b = rgba[p * 4 + 2] - mean[2];
+        covariance[0] += r * r;
+        covariance[1] += r * g;
+        covariance[2] += r * b;
+        covariance[3] += g * g;
+        covariance[4] += g * b;
+        covariance[5] += b * b;
+    }
+
+    //glavna osa stepenim metodom
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+        float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+        float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+        float length = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+        if (length < 1e-6f) {
+            break;
+        }
+        axis[0] = x / length;
+        axis[1] = y / length;
+        axis[2] = z / length;
+    }
+    float axis_length_squared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+    float min_projection = 0.0f, max_projection = 0.0f;
+    for (int p = 0; p < 16; p++) {
+        float projection = 0.0f;
+        for (int i = 0; i < 3; i++) {
+            projection += (rgba[p * 4 + i] - mean[i]) * axis[i];
+        }
+        min_projection = std::min(min_projection, projection);
+        max_projection = std::max(max_projection, projection);
+    }
+
+    float end0[3], end1[3];
+    for (int i = 0; i < 3; i++) {
+        end0[i] = mean[i] + axis[i] * max_projection / axis_length_squared;
+        end1[i] = mean[i] + axis[i] * min_projection / axis_length_squared;
+    }
+
+    uint16_t c0 = packRgb565(end0);
+    uint16_t c1 = packRgb565(end1);
+    if (c0 < c1) {
+        std::swap(c0, c1);
+    }
+
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        int palette[4][4];
+        colorPalette(c0, c1, true, palette);
+        for (int p = 0; p < 16; p++) {
+            int best = 0, best_distance = 1 << 30;
+            for (int candidate = 0; candidate < 4; candidate++) {
+                int distance = 0;
+                for (int i = 0; i < 3; i++) {
+                    int difference = rgba[p * 4 + i] - palette[candidate][i];
+                    distance += difference * difference;
+                }
+                if (distance < best_distance) {
+                    best_distance = distance;
+                    best = candidate;
+                }
+            }
+            indices |= (uint32_t) best << (2 * p);
+        }
+    }
+
+    out[0] = (unsigned char) (c0 & 0xff);
+    out[1] = (unsigned char) (c0 >> 8);
+    out[2] = (unsigned char) (c1 & 0xff);
+    out[3] = (unsigned char) (c1 >> 8);
+    for (int i = 0; i < 4; i++) {
+        out[4 + i] = (unsigned char) (indices >> (8 * i));
+    }
+}
+
+//za BC3 je boja uvek u 4-bojnom rezimu, za BC1 odlucuje redosled krajnjih boja
+inline void decodeColorBlock(const unsigned char in[8], unsigned char rgba[16 * 4], bool always_four_colors) {
+    uint16_t c0 = (uint16_t) (in[0] | (in[1] << 8));
+    uint16_t c1 = (uint16_t) (in[2] | (in[3] << 8));
+    uint32_t indices = (uint32_t) in[4] | ((uint32_t) in[5] << 8) | ((uint32_t) in[6] << 16) | ((uint32_t) in[7] << 24);
+
+    int palette[4][4];
+    colorPalette(c0, c1, always_four_colors || c0 > c1, palette);
+    for (int p = 0; p < 16; p++) {
+        int index = (indices >> (2 * p)) & 3;
+        for (int i = 0; i < 4; i++) {
+            rgba[p * 4 + i] = (unsigned char) palette[index][i];
+        }
+    }
+}
+
+inline void channelPalette(int a0, int a1, int palette[8]) {
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1) {
+        for (int i = 2; i < 8; i++) {
+            palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+        }
+    } else {
+        for (int i = 2; i < 6; i++) {
+            palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+//BC4 blok od 16 vrednosti jednog kanala, u 8-vrednosnom rezimu izmedju minimuma i maksimuma
+inline void encodeChannelBlock(const unsigned char values[16], unsigned char out[8]) {
+    int a0 = *std::max_element(values, values + 16);
+    int a1 = *std::min_element(values, values + 16);
+
+    uint64_t indices = 0;
+    if (a0 != a1) {
+        int palette[8];
+        channelPalette(a0, a1, palette);
+        for (int p = 0; p < 16; p++) {
+            int best = 0, best_distance = 1 << 30;
+            for (int candidate = 0; candidate < 8; candidate++) {
+                int distance = std::abs(values[p] - palette[candidate]);
+                if (distance < best_distance) {
+                    best_distance = distance;
+                    best = candidate;
+                }
+            }
+            indices |= (uint64_t) best << (3 * p);
+        }
+    }
+
+    out[0] = (unsigned char) a0;
+    out[1] = (unsigned char) a1;
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = (unsigned char) (indices >> (8 * i));
+    }
+}
+
+inline void decodeChannelBlock(const unsigned char in[8], unsigned char values[16]) {
+    int palette[8];
+    channelPalette(in[0], in[1], palette);
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; i++) {
+        indices |= (uint64_t) in[2 + i] << (8 * i);
+    }
+    for (int p = 0; p < 16; p++) {
+        values[p] = (unsigned char) palette[(indices >> (3 * p)) & 7];
+    }
+}
+
+}
+
+}
+
+#endif //PROJECT_BASE_BLOCKCOMPRESSION_H
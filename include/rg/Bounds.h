@@ -0,0 +1,85 @@
+#ifndef PROJECT_BASE_BOUNDS_H
+#define PROJECT_BASE_BOUNDS_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace rg {
+
+//osno poravnat granicni kvadar, prazan dok se ne prosiri prvom tackom
+struct AABB {
+    glm::vec3 m_min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 m_max = glm::vec3(-std::numeric_limits<float>::max());
+
+    bool isValid() const {
+        return m_min.x <= m_max.x && m_min.y <= m_max.y && m_min.z <= m_max.z;
+    }
+
+    void extend(const glm::vec3& point) {
+        m_min = glm::min(m_min, point);
+        m_max = glm::max(m_max, point);
+    }
+
+    void extend(const AABB& other) {
+        if (other.isValid()) {
+            extend(other.m_min);
+            extend(other.m_max);
+        }
+    }
+
+    glm::vec3 center() const {
+        return (m_min + m_max) * 0.5f;
+    }
+
+    glm::vec3 extents() const {
+        return (m_max - m_min) * 0.5f;
+    }
+
+    //najmanji osno poravnat kvadar oko transformisanog kvadra (Arvo)
+    AABB transformed(const glm::mat4& matrix) const {
+        AABB result;
+        if (!isValid()) {
+            return result;
+        }
+        glm::vec3 center = glm::vec3(matrix * glm::vec4(this->center(), 1.0f));
+        glm::vec3 half = extents();
+        glm::vec3 world_half(0.0f);
+        for (int column = 0; column < 3; column++) {
+            world_half += glm::abs(glm::vec3(matrix[column])) * half[column];
+        }
+        result.m_min = center - world_half;
+        result.m_max = center + world_half;
+        return result;
+    }
+};
+
+//granicna sfera; centar se postavlja unapred (obicno centar AABB-a), a poluprecnik raste da obuhvati tacke
+struct Sphere {
+    glm::vec3 m_center = glm::vec3(0.0f);
+    float m_radius = 0.0f;
+
+    void include(const glm::vec3& point) {
+        m_radius = std::max(m_radius, glm::length(point - m_center));
+    }
+
+    void include(const Sphere& other) {
+        m_radius = std::max(m_radius, glm::length(other.m_center - m_center) + other.m_radius);
+    }
+
+    //sfera posle transformacije; poluprecnik se skalira najvecim skaliranjem po osi
+    Sphere transformed(const glm::mat4& matrix) const {
+        float scale = std::max(glm::length(glm::vec3(matrix[0])),
+                               std::max(glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2]))));
+        Sphere result;
+        result.m_center = glm::vec3(matrix * glm::vec4(m_center, 1.0f));
+        result.m_radius = m_radius * scale;
+        return result;
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_BOUNDS_H
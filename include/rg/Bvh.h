@@ -0,0 +1,427 @@
+#ifndef PROJECT_BASE_BVH_H
+#define PROJECT_BASE_BVH_H
+
+#include <glm/glm.hpp>
+
+#include <rg/Bounds.h>
+#include <rg/Frustum.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace rg {
+
+//cvor hijerarhije: list ima m_count > 0 objekata od m_first u m_items,
+//unutrasnji cvor ima m_count == 0 i decu m_first i m_first + 1
+struct BvhNode {
+    AABB m_bounds;
+    uint32_t m_first = 0;
+    uint32_t m_count = 0;
+
+    bool isLeaf() const {
+        return m_count > 0;
+    }
+};
+
+//hijerarhija granicnih kvadara nad instancama scene
+//gradi se binovanim SAH-om, pomeranje objekata se prati refit-om bez promene topologije
+class Bvh {
+public:
+    //broj binova po osi pri izboru podele i najveci broj objekata u listu
+    static const unsigned int BIN_COUNT = 16;
+    static const unsigned int MAX_LEAF_SIZE = 4;
+
+    //cena obilaska cvora u odnosu na test jednog objekta, za SAH
+    static constexpr float TRAVERSAL_COST = 1.0f;
+
+    //najveca dubina stabla, ujedno velicina steka pri obilasku
+    static const unsigned int MAX_DEPTH = 64;
+
+    size_t size() const {
+        return m_item_bounds.size();
+    }
+
+    size_t nodeCount() const {
+        return m_nodes.size();
+    }
+
+    const AABB& bounds(uint32_t item) const {
+        return m_item_bounds[item];
+    }
+
+    void build(const std::vector<AABB>& bounds) {
+        m_item_bounds = bounds;
+        m_nodes.clear();
+        m_parents.clear();
+        m_items.resize(bounds.size());
+        m_item_leaf.assign(bounds.size(), 0);
+        if (bounds.empty()) {
+            return;
+        }
+
+        std::vector<glm::vec3> centroids(bounds.size());
+        for (uint32_t i = 0; i < bounds.size(); i++) {
+            m_items[i] = i;
+            centroids[i] = bounds[i].center();
+        }
+
+        m_nodes.reserve(bounds.size() * 2 / MAX_LEAF_SIZE + 1);
+        m_nodes.emplace_back();
+        m_parents.push_back(0);
+        m_nodes[0].m_first = 0;
+        m_nodes[0].m_count = (uint32_t) bounds.size();
+
+        //par (cvor, dubina); cvor na najvecoj dubini ostaje list bez obzira na velicinu
+        std::vector<std::pair<uint32_t, unsigned int>> stack{{0, 1}};
+        while (!stack.empty()) {
+            uint32_t index = stack.back().first;
+            unsigned int depth = stack.back().second;
+            stack.pop_back();
+            if (depth < MAX_DEPTH && split(index, centroids)) {
+                uint32_t left = m_nodes[index].m_first;
+                stack.push_back({left, depth + 1});
+                stack.push_back({left + 1, depth + 1});
+            }
+        }
+        refit();
+    }
+
+    //ponovo racuna granice svih cvorova iz trenutnih granica objekata, O(n)
+    void refit() {
+        //deca su uvek iza roditelja u nizu, pa je obrnuti redosled odozdo nagore
+        for (size_t i = m_nodes.size(); i-- > 0;) {
+            BvhNode& node = m_nodes[i];
+            node.m_bounds = AABB();
+            if (node.isLeaf()) {
+                for (uint32_t j = node.m_first; j < node.m_first + node.m_count; j++) {
+                    node.m_bounds.extend(m_item_bounds[m_items[j]]);
+                    m_item_leaf[m_items[j]] = (uint32_t) i;
+                }
+            } else {
+                node.m_bounds.extend(m_nodes[node.m_first].m_bounds);
+                node.m_bounds.extend(m_nodes[node.m_first + 1].m_bounds);
+            }
+        }
+    }
+
+    void refit(const std::vector<AABB>& bounds) {
+        m_item_bounds = bounds;
+        refit();
+    }
+
+    //pomeren jedan objekat: osvezava se samo put od njegovog lista do korena
+    void update(uint32_t item, const AABB& bounds) {
+        m_item_bounds[item] = bounds;
+        uint32_t index = m_item_leaf[item];
+        while (true) {
+            BvhNode& node = m_nodes[index];
+            AABB previous = node.m_bounds;
+            node.m_bounds = AABB();
+            if (node.isLeaf()) {
+                for (uint32_t j = node.m_first; j < node.m_first + node.m_count; j++) {
+                    node.m_bounds.extend(m_item_bounds[m_items[j]]);
+                }
+            } else {
+                node.m_bounds.extend(m_nodes[node.m_first].m_bounds);
+                node.m_bounds.extend(m_nodes[node.m_first + 1].m_bounds);
+            }
+            bool unchanged = previous.m_min == node.m_bounds.m_min && previous.m_max == node.m_bounds.m_max;
+            if (index == 0 || unchanged) {
+                break;
+            }
+            index = m_parents[index];
+        }
+    }
+
+    //poziva visit(item) za svaki objekat ciji AABB sece frustum
+    //cvor ceo unutar neke ravni ne testira tu ravan ni za potomke
+    template <typename F>
+    void queryFrustum(const Frustum& frustum, F visit) const {
+        if (m_nodes.empty()) {
+            return;
+        }
+        const unsigned int all_planes = (1u << Frustum::PlaneCount) - 1;
+        struct Entry {
+            uint32_t m_node;
+            unsigned int m_planes;
+        };
+        Entry stack[MAX_DEPTH + 1];
+        int top = 0;
+        stack[top++] = {0, all_planes};
+        while (top > 0) {
+            Entry entry = stack[--top];
+            const BvhNode& node = m_nodes[entry.m_node];
+            unsigned int planes = entry.m_planes;
+            if (!classify(frustum, node.m_bounds, planes)) {
+                continue;
+            }
+
+            if (node.isLeaf()) {
+                for (uint32_t j = node.m_first; j < node.m_first + node.m_count; j++) {
+                    uint32_t item = m_items[j];
+                    unsigned int item_planes = planes;
+                    if (classify(frustum, m_item_bounds[item], item_planes)) {
+                        visit(item);
+                    }
+                }
+            } else {
+                stack[top++] = {node.m_first + 1, planes};
+                stack[top++] = {node.m_first, planes};
+            }
+        }
+    }
+
+    //najblizi objekat ciji AABB zrak pogadja na rastojanju najvise max_distance, -1 ako ga nema
+    //direction ne mora biti jedinicni, rastojanje je u jedinicama direction
+    int raycast(const glm::vec3& origin, const glm::vec3& direction, float max_distance, float& distance) const {
+        int closest = -1;
+        distance = max_distance;
+        if (m_nodes.empty()) {
+            return closest;
+        }
+
+        glm::vec3 inverse(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        uint32_t stack[MAX_DEPTH + 1];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const BvhNode& node = m_nodes[stack[--top]];
+            float enter;
+            if (!intersectRay(node.m_bounds, origin, inverse, distance, enter)) {
+                continue;
+            }
+
+            if (node.isLeaf()) {
+                for (uint32_t j = node.m_first; j < node.m_first + node.m_count; j++) {
+                    uint32_t item = m_items[j];
+                    if (intersectRay(m_item_bounds[item], origin, inverse, distance, enter) && enter < distance) {
+                        distance = enter;
+                        closest = (int) item;
+                    }
+                }
+                continue;
+            }
+
+            //blize dete se obilazi prvo, da bi distance brze opadao
+            uint32_t near_child = node.m_first, far_child = node.m_first + 1;
+            float near_enter, far_enter;
+            bool near_hit = intersectRay(m_nodes[near_child].m_bounds, origin, inverse, distance, near_enter);
+            bool far_hit = intersectRay(m_nodes[far_child].m_bounds, origin, inverse, distance, far_enter);
+            if (far_hit && (!near_hit || far_enter < near_enter)) {
+                std::swap(near_child, far_child);
+                std::swap(near_hit, far_hit);
+            }
+            if (far_hit) {
+                stack[top++] = far_child;
+            }
+            if (near_hit) {
+                stack[top++] = near_child;
+            }
+        }
+        return closest;
+    }
+
+    //poziva visit(item) za svaki objekat ciji AABB sece sferu
+    template <typename F>
+    void queryRadius(const glm::vec3& center, float radius, F visit) const {
+        if (m_nodes.empty()) {
+            return;
+        }
+        float radius_squared = radius * radius;
+        uint32_t stack[MAX_DEPTH + 1];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const BvhNode& node = m_nodes[stack[--top]];
+            if (distanceSquared(node.m_bounds, center) > radius_squared) {
+                continue;
+            }
+            if (node.isLeaf()) {
+                for (uint32_t j = node.m_first; j < node.m_first + node.m_count; j++) {
+                    if (distanceSquared(m_item_bounds[m_items[j]], center) <= radius_squared) {
+                        visit(m_items[j]);
+                    }
+                }
+            } else {
+                stack[top++] = node.m_first + 1;
+                stack[top++] = node.m_first;
+            }
+        }
+    }
+
+    //kvadrat rastojanja tacke od kvadra, 0 ako je tacka unutra
+    static float distanceSquared(const AABB& box, const glm::vec3& point) {
+        glm::vec3 closest = glm::clamp(point, box.m_min, box.m_max);
+        glm::vec3 delta = point - closest;
+        return glm::dot(delta, delta);
+    }
+
+    //slab test; enter je rastojanje ulaska (0 ako je pocetak zraka unutra)
+    static bool intersectRay(const AABB& box, const glm::vec3& origin, const glm::vec3& inverse_direction,
+                             float max_distance, float& enter) {
+        glm::vec3 t0 = (box.m_min - origin) * inverse_direction;
+        glm::vec3 t1 = (box.m_max - origin) * inverse_direction;
+        glm::vec3 t_min = glm::min(t0, t1);
+        glm::vec3 t_max = glm::max(t0, t1);
+        enter = std::max(std::max(t_min.x, t_min.y), std::max(t_min.z, 0.0f));
+        float exit = std::min(std::min(t_max.x, t_max.y), std::min(t_max.z, max_distance));
+        return enter <= exit;
+    }
+
+private:
+    std::vector<BvhNode> m_nodes;
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_items;
+    std::vector<uint32_t> m_item_leaf;
+    std::vector<AABB> m_item_bounds;
+
+    //false ako je kvadar ceo iza neke ravni; iz planes se brisu ravni ispred kojih je ceo kvadar
+    //p-teme je kao u Frustum::intersects, pa je rezultat za list isti kao test jednog AABB-a
+    static bool classify(const Frustum& frustum, const AABB& box, unsigned int& planes) {
+        if (!box.isValid()) {
+            return false;
+        }
+        for (int p = 0; p < Frustum::PlaneCount; p++) {
+            unsigned int bit = 1u << p;
+            if (!(planes & bit)) {
+                continue;
+            }
+            const glm::vec4& plane = frustum.m_planes[p];
+            glm::vec3 normal(plane);
+            glm::vec3 positive(plane.x >= 0.0f ? box.m_max.x : box.m_min.x,
+                               plane.y >= 0.0f ? box.m_max.y : box.m_min.y,
+                               plane.z >= 0.0f ? box.m_max.z : box.m_min.z);
+            if (glm::dot(normal, positive) + plane.w < 0.0f) {
+                return false;
+            }
+            glm::vec3 negative(plane.x >= 0.0f ? box.m_min.x : box.m_max.x,
+                               plane.y >= 0.0f ? box.m_min.y : box.m_max.y,
+                               plane.z >= 0.0f ? box.m_min.z : box.m_max.z);
+            if (glm::dot(normal, negative) + plane.w >= 0.0f) {
+                planes &= ~bit;
+            }
+        }
+        return true;
+    }
+
+    static float surfaceArea(const AABB& box) {
+        if (!box.isValid()) {
+            return 0.0f;
+        }
+        glm::vec3 size = box.m_max - box.m_min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    //deli list po najjeftinijoj SAH podeli centroida; false ako je list jeftiniji od svake podele
+    bool split(uint32_t index, const std::vector<glm::vec3>& centroids) {
+        uint32_t first = m_nodes[index].m_first;
+        uint32_t count = m_nodes[index].m_count;
+        if (count <= MAX_LEAF_SIZE) {
+            return false;
+        }
+
+        AABB node_bounds, centroid_bounds;
+        for (uint32_t j = first; j < first + count; j++) {
+            node_bounds.extend(m_item_bounds[m_items[j]]);
+            centroid_bounds.extend(centroids[m_items[j]]);
+        }
+
+        //binovi na sve tri ose se pune u jednom prolazu kroz objekte
+        //cena podele je SA(levo) * n(levo) + SA(desno) * n(desno)
+        glm::vec3 low = centroid_bounds.m_min;
+        glm::vec3 range = centroid_bounds.m_max - centroid_bounds.m_min;
+        glm::vec3 scale(0.0f);
+        for (int axis = 0; axis < 3; axis++) {
+            scale[axis] = range[axis] > 0.0f ? BIN_COUNT / range[axis] : 0.0f;
+        }
+        AABB bin_bounds[3][BIN_COUNT];
+        uint32_t bin_counts[3][BIN_COUNT] = {};
+        for (uint32_t j = first; j < first + count; j++) {
+            uint32_t item = m_items[j];
+            const AABB& box = m_item_bounds[item];
+            glm::vec3 offset = (centroids[item] - low) * scale;
+            for (int axis = 0; axis < 3; axis++) {
+                unsigned int bin = std::min(BIN_COUNT - 1, (unsigned int) offset[axis]);
+                bin_counts[axis][bin]++;
+                bin_bounds[axis][bin].extend(box);
+            }
+        }
+
+        int best_axis = -1;
+        unsigned int best_bin = 0;
+        float best_cost = std::numeric_limits<float>::max();
+        for (int axis = 0; axis < 3; axis++) {
+            if (range[axis] <= 0.0f) {
+                continue;
+            }
+            float left_area[BIN_COUNT - 1];
+            uint32_t left_count[BIN_COUNT - 1];
+            AABB accumulated;
+            uint32_t accumulated_count = 0;
+            for (unsigned int b = 0; b < BIN_COUNT - 1; b++) {
+                accumulated.extend(bin_bounds[axis][b]);
+                accumulated_count += bin_counts[axis][b];
+                left_area[b] = surfaceArea(accumulated);
+                left_count[b] = accumulated_count;
+            }
+            accumulated = AABB();
+            accumulated_count = 0;
+            for (unsigned int b = BIN_COUNT - 1; b > 0; b--) {
+                accumulated.extend(bin_bounds[axis][b]);
+                accumulated_count += bin_counts[axis][b];
+                if (left_count[b - 1] == 0 || accumulated_count == 0) {
+                    continue;
+                }
+                float cost = left_area[b - 1] * left_count[b - 1] + surfaceArea(accumulated) * accumulated_count;
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_bin = b;
+                }
+            }
+        }
+
+        //svi centroidi u istoj tacki ili je list jeftiniji: ostaje list, osim ako je prevelik
+        float leaf_cost = surfaceArea(node_bounds) * count;
+        float split_cost = TRAVERSAL_COST * surfaceArea(node_bounds) + best_cost;
+        uint32_t middle;
+        if (best_axis < 0 || split_cost >= leaf_cost) {
+            if (count <= MAX_LEAF_SIZE * 4) {
+                return false;
+            }
+            //prevelik list: podela na pola po najduzoj osi centroida
+            int axis = range.x >= range.y && range.x >= range.z ? 0 : (range.y >= range.z ? 1 : 2);
+            middle = first + count / 2;
+            std::nth_element(m_items.begin() + first, m_items.begin() + middle, m_items.begin() + first + count,
+                             [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+        } else {
+            auto left_of_split = [&](uint32_t item) {
+                float offset = (centroids[item][best_axis] - low[best_axis]) * scale[best_axis];
+                return std::min(BIN_COUNT - 1, (unsigned int) offset) < best_bin;
+            };
+            middle = (uint32_t) (std::partition(m_items.begin() + first, m_items.begin() + first + count, left_of_split)
+                                 - m_items.begin());
+        }
+
+        uint32_t left = (uint32_t) m_nodes.size();
+        m_nodes.emplace_back();
+        m_nodes.emplace_back();
+        m_parents.push_back(index);
+        m_parents.push_back(index);
+        m_nodes[left].m_first = first;
+        m_nodes[left].m_count = middle - first;
+        m_nodes[left + 1].m_first = middle;
+        m_nodes[left + 1].m_count = first + count - middle;
+        m_nodes[index].m_first = left;
+        m_nodes[index].m_count = 0;
+        return true;
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_BVH_H
@@ -0,0 +1,405 @@
+#ifndef PROJECT_BASE_CLUSTEREDLIGHTS_H
+#define PROJECT_BASE_CLUSTEREDLIGHTS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/CullKernel.h>
+#include <rg/FrameStats.h>
+#include <rg/Shader.h>
+#include <rg/ThreadPool.h>
+#include <rg/UniformBuffer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <vector>
+
+namespace rg {
+
+//svetlo klasterovanog osvetljenja; tackasto svetlo je reflektor cija kupa obuhvata sve pravce
+struct ClusterLight {
+    glm::vec3 m_position = glm::vec3(0.0f);
+    float m_radius = 1.0f; // domet, na njemu slabljenje pada na nulu
+    glm::vec3 m_color = glm::vec3(1.0f);
+    glm::vec3 m_direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    float m_cos_inner = -1.5f;
+    float m_cos_outer = -2.0f;
+
+    static ClusterLight point(const glm::vec3& position, float radius, const glm::vec3& color) {
+        ClusterLight light;
+        light.m_position = position;
+        light.m_radius = radius;
+        light.m_color = color;
+        return light;
+    }
+
+    //uglovi su polovine otvora kupe u stepenima
+    static ClusterLight spot(const glm::vec3& position, const glm::vec3& direction, float radius, const glm::vec3& color,
+                             float inner_degrees, float outer_degrees) {
+        ClusterLight light = point(position, radius, color);
+        light.m_direction = glm::normalize(direction);
+        light.m_cos_inner = std::cos(glm::radians(inner_degrees));
+        light.m_cos_outer = std::cos(glm::radians(outer_degrees));
+        return light;
+    }
+};
+
+namespace detail {
+
+//kvadar klastera u prostoru kamere, dubina je pozitivna
+struct ClusterBox {
+    float m_min_x, m_max_x;
+    float m_min_y, m_max_y;
+    float m_near, m_far;
+};
+
+//svetla koja dosezu dubine jednog preseka, po komponentama, i liste svih klastera preseka redom
+struct LightSlice {
+    std::vector<float> m_x, m_y, m_depth, m_radius;
+    std::vector<uint16_t> m_light; // indeks svetla u ulaznom nizu
+    std::vector<uint16_t> m_indices;
+};
+
+//sfera sece kvadar ako je kvadrat rastojanja centra od kvadra najvise kvadrat poluprecnika
+//reflektor se testira sferom dometa, sto je konzervativno
+inline void binClusterScalar(const LightSlice& slice, const ClusterBox& box, size_t begin, std::vector<uint16_t>& out) {
+    for (size_t i = begin; i < slice.m_radius.size(); i++) {
+        float dx = std::max(box.m_min_x - slice.m_x[i], 0.0f) + std::max(slice.m_x[i] - box.m_max_x, 0.0f);
+        float dy = std::max(box.m_min_y - slice.m_y[i], 0.0f) + std::max(slice.m_y[i] - box.m_max_y, 0.0f);
+        float dz = std::max(box.m_near - slice.m_depth[i], 0.0f) + std::max(slice.m_depth[i] - box.m_far, 0.0f);
+        if (dx * dx + dy * dy + dz * dz <= slice.m_radius[i] * slice.m_radius[i]) {
+            out.push_back(slice.m_light[i]);
+        }
+    }
+}
+
+#ifdef RG_CULL_X86
+
+//4 svetla po iteraciji; vraca broj obradjenih svetala, ostatak obradjuje skalarna verzija
+inline size_t binClusterSse(const LightSlice& slice, const ClusterBox& box, std::vector<uint16_t>& out) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 min_x = _mm_set1_ps(box.m_min_x), max_x = _mm_set1_ps(box.m_max_x);
+    const __m128 min_y = _mm_set1_ps(box.m_min_y), max_y = _mm_set1_ps(box.m_max_y);
+    const __m128 near_depth = _mm_set1_ps(box.m_near), far_depth = _mm_set1_ps(box.m_far);
+
+    size_t n = slice.m_radius.size() & ~(size_t) 3;
+    for (size_t i = 0; i < n; i += 4) {
+        __m128 x = _mm_loadu_ps(slice.m_x.data() + i);
+        __m128 y = _mm_loadu_ps(slice.m_y.data() + i);
+        __m128 depth = _mm_loadu_ps(slice.m_depth.data() + i);
+        __m128 radius = _mm_loadu_ps(slice.m_radius.data() + i);
+
+        __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(min_x, x), zero), _mm_max_ps(_mm_sub_ps(x, max_x), zero));
+        __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(min_y, y), zero), _mm_max_ps(_mm_sub_ps(y, max_y), zero));
+        __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(near_depth, depth), zero), _mm_max_ps(_mm_sub_ps(depth, far_depth), zero));
+        __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+        int mask = _mm_movemask_ps(_mm_cmple_ps(distance, _mm_mul_ps(radius, radius)));
+        while (mask != 0) {
+            out.push_back(slice.m_light[i + __builtin_ctz(mask)]);
+            mask &= mask - 1;
+        }
+    }
+    return n;
+}
+
+#endif
+
+inline void binCluster(const LightSlice& slice, const ClusterBox& box, std::vector<uint16_t>& out) {
+    size_t done = 0;
+#ifdef RG_CULL_X86
+    done = binClusterSse(slice, box, out);
+#endif
+    binClusterScalar(slice, box, done, out);
+}
+
+}
+
+//klasterovano osvetljenje unapred: piramida pogleda je podeljena na GRID_X x GRID_Y plocica ekrana i GRID_Z preseka
+//po dubini (eksponencijalno, da bi klasteri bili priblizno kocke), svetla se svakog frejma rasporedjuju po klasterima
+//na CPU-u, a fragment shader prolazi samo kroz svetla svog klastera
+//podaci idu kroz tri texture buffer-a: svetla (RGBA32F, tri teksela po svetlu), pocetak i duzina liste svakog
+//klastera (RG32UI) i spojene liste indeksa svetala (R16UI); UBO od 64KB ne bi primio liste za stotine svetala
+class ClusteredLights {
+public:
+    static const unsigned int GRID_X = 16;
+    static const unsigned int GRID_Y = 9;
+    static const unsigned int GRID_Z = 24;
+    static const unsigned int TILE_COUNT = GRID_X * GRID_Y;
+    static const unsigned int CLUSTER_COUNT = TILE_COUNT * GRID_Z;
+    //indeksi svetala su 16-bitni
+    static const unsigned int MAX_LIGHTS = 65536;
+    //jedinice tekstura iznad onih koje koriste materijali; RenderQueue menja samo GL_TEXTURE_2D
+    static const unsigned int LIGHT_UNIT = 13;
+    static const unsigned int RANGE_UNIT = 14;
+    static const unsigned int INDEX_UNIT = 15;
+    //sa manje svetala raspodela na jednoj niti je brza od slanja poslova
+    static const unsigned int PARALLEL_MIN_LIGHTS = 64;
+
+    ClusteredLights() : m_uniforms(CLUSTER_BLOCK_BINDING), m_boxes(CLUSTER_COUNT), m_slices(GRID_Z),
+                        m_ranges(CLUSTER_COUNT * 2, 0) {}
+
+    ClusteredLights(const ClusteredLights&) = delete;
+    ClusteredLights& operator=(const ClusteredLights&) = delete;
+
+    ~ClusteredLights() {
+        release();
+    }
+
+    void release() {
+        for (unsigned int i = 0; i < BUFFER_COUNT; i++) {
+            if (m_textures[i] != 0) {
+                glDeleteTextures(1, &m_textures[i]);
+                glDeleteBuffers(1, &m_buffers[i]);
+            }
+            m_textures[i] = 0;
+            m_buffers[i] = 0;
+        }
+    }
+
+    //sampler-i texture buffer-a se vezuju za stalne jedinice; poziva se iz setup-a varijanti shader-a
+    static void setSamplers(Shader& shader) {
+        shader.use();
+        shader.setInt("clusterLights", LIGHT_UNIT);
+        shader.setInt("clusterRanges", RANGE_UNIT);
+        shader.setInt("clusterIndices", INDEX_UNIT);
+    }
+
+    //kvadri klastera u prostoru kamere; racunaju se ponovo samo kad se projekcija ili velicina ekrana promene
+    void setProjection(const glm::mat4& projection, float near_plane, float far_plane, unsigned int width, unsigned int height) {
+        if (m_has_projection && projection == m_projection && near_plane == m_near && far_plane == m_far &&
+            width == m_width && height == m_height)
+            return;
+        m_has_projection = true;
+        m_projection = projection;
+        m_near = near_plane;
+        m_far = far_plane;
+        m_width = width;
+        m_height = height;
+
+        //presek z pokriva dubine near * (far / near)^(z / GRID_Z) do sledece granice,
+        //pa je indeks preseka log(dubina) * skala + pomeraj
+        float log_ratio = std::log(far_plane / near_plane);
+        m_data.m_grid = glm::uvec4(GRID_X, GRID_Y, GRID_Z, 0);
+        m_data.m_depth = glm::vec4(GRID_Z / log_ratio, -(float) GRID_Z * std::log(near_plane) / log_ratio,
+                                   (float) width / GRID_X, (float) height / GRID_Y);
+
+        //temena plocica na ravni z = -1, pa se x i y na dubini d dobijaju mnozenjem sa d
+        glm::mat4 inverse = glm::inverse(projection);
+        for (unsigned int y = 0; y < GRID_Y; y++) {
+            for (unsigned int x = 0; x < GRID_X; x++) {
+                float min_x = 0.0f, max_x = 0.0f, min_y = 0.0f, max_y = 0.0f;
+                for (unsigned int corner = 0; corner < 4; corner++) {
+                    float ndc_x = 2.0f * (float) (x + (corner & 1)) / GRID_X - 1.0f;
+                    float ndc_y = 2.0f * (float) (y + (corner >> 1)) / GRID_Y - 1.0f;
+                    glm::vec4 point = inverse * glm::vec4(ndc_x, ndc_y, -1.0f, 1.0f);
+                    float ray_x = point.x / -point.z;
+                    float ray_y = point.y / -point.z;
+                    min_x = corner == 0 ? ray_x : std::min(min_x, ray_x);
+                    max_x = corner == 0 ? ray_x : std::max(max_x, ray_x);
+                    min_y = corner == 0 ? ray_y : std::min(min_y, ray_y);
+                    max_y = corner == 0 ? ray_y : std::max(max_y, ray_y);
+                }
+
+                for (unsigned int z = 0; z < GRID_Z; z++) {
+                    detail::ClusterBox& box = m_boxes[clusterIndex(x, y, z)];
+                    box.m_near = near_plane * std::pow(far_plane / near_plane, (float) z / GRID_Z);
+                    box.m_far = near_plane * std::pow(far_plane / near_plane, (float) (z + 1) / GRID_Z);
+                    box.m_min_x = std::min(min_x * box.m_near, min_x * box.m_far);
+                    box.m_max_x = std::max(max_x * box.m_near, max_x * box.m_far);
+                    box.m_min_y = std::min(min_y * box.m_near, min_y * box.m_far);
+                    box.m_max_y = std::max(max_y * box.m_near, max_y * box.m_far);
+                }
+            }
+        }
+    }
+
+    //rasporedjuje svetla po klasterima za matricu pogleda frejma i salje liste na GPU
+    //preseci se dele na poslove ThreadPool-a, ali samo na niti koje su slobodne, jer isti skup ucitava modele i
+    //kompresuje teksture; render nit bi inace cekala da se ti poslovi zavrse; svaki posao pise samo liste svojih preseka
+    void update(const std::vector<ClusterLight>& lights, const glm::mat4& view) {
+        auto start = std::chrono::steady_clock::now();
+        size_t count = lights.size();
+        if (count > MAX_LIGHTS) {
+            if (!m_overflow_reported) {
+                std::cerr << "ERROR::CLUSTERED_LIGHTS::PREVISE_SVETALA " << count << ", koristi se prvih " << MAX_LIGHTS << "\n";
+                m_overflow_reported = true;
+            }
+            count = MAX_LIGHTS;
+        }
+
+        m_x.resize(count);
+        m_y.resize(count);
+        m_depth.resize(count);
+        m_radius.resize(count);
+        m_light_data.resize(count * 3);
+        for (size_t i = 0; i < count; i++) {
+            const ClusterLight& light = lights[i];
+            glm::vec4 position = view * glm::vec4(light.m_position, 1.0f);
+            m_x[i] = position.x;
+            m_y[i] = position.y;
+            m_depth[i] = -position.z;
+            m_radius[i] = light.m_radius;
+            m_light_data[3 * i] = glm::vec4(light.m_position, light.m_radius);
+            m_light_data[3 * i + 1] = glm::vec4(light.m_color, light.m_cos_inner);
+            m_light_data[3 * i + 2] = glm::vec4(light.m_direction, light.m_cos_outer);
+        }
+
+        //pozivajuca nit obradjuje prvi deo preseka dok slobodne radne niti rade ostale; bez slobodnih niti
+        //(npr. dok se modeli ucitavaju u pozadini) sve radi sama
+        unsigned int jobs = count < PARALLEL_MIN_LIGHTS ? 1 : std::min(ThreadPool::instance().idleThreads() + 1, (unsigned int) GRID_Z);
+        std::vector<std::future<void>> futures;
+        for (unsigned int job = 1; job < jobs; job++) {
+            unsigned int begin = GRID_Z * job / jobs;
+            unsigned int end = GRID_Z * (job + 1) / jobs;
+            futures.push_back(ThreadPool::instance().submit([this, begin, end] { binSlices(begin, end); }));
+        }
+        binSlices(0, GRID_Z / jobs);
+        for (std::future<void>& future : futures) {
+            future.get();
+        }
+
+        //liste preseka se spajaju redom, pocetak svake liste se pomera za duzinu prethodnih preseka
+        m_indices.clear();
+        for (unsigned int z = 0; z < GRID_Z; z++) {
+            uint32_t base = (uint32_t) m_indices.size();
+            for (unsigned int tile = 0; tile < TILE_COUNT; tile++) {
+                m_ranges[2 * (z * TILE_COUNT + tile)] += base;
+            }
+            m_indices.insert(m_indices.end(), m_slices[z].m_indices.begin(), m_slices[z].m_indices.end());
+        }
+
+        m_visible.assign(count, 0);
+        for (uint16_t index : m_indices) {
+            m_visible[index] = 1;
+        }
+        m_visible_count = (size_t) std::count(m_visible.begin(), m_visible.end(), 1);
+
+        m_data.m_grid.w = (unsigned int) count;
+        m_uniforms.update(m_data);
+        upload(0, GL_RGBA32F, m_light_data.data(), m_light_data.size() * sizeof(glm::vec4));
+        upload(1, GL_RG32UI, m_ranges.data(), m_ranges.size() * sizeof(uint32_t));
+        upload(2, GL_R16UI, m_indices.data(), m_indices.size() * sizeof(uint16_t));
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        FrameStats::instance().recordLightBinning(m_visible_count, m_indices.size(), ms);
+    }
+
+    //vezuje texture buffer-e na njihove jedinice, pre crtanja objekata sa CLUSTERED_LIGHTS
+    void bind() const {
+        for (unsigned int i = 0; i < BUFFER_COUNT; i++) {
+            glActiveTexture(GL_TEXTURE0 + LIGHT_UNIT + i);
+            glBindTexture(GL_TEXTURE_BUFFER, m_textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    //svetla koja pogadjaju bar jedan klaster i zbir duzina svih lista, iz poslednjeg update-a
+    size_t visibleLights() const {
+        return m_visible_count;
+    }
+
+    size_t references() const {
+        return m_indices.size();
+    }
+
+private:
+    static const unsigned int BUFFER_COUNT = 3;
+
+    UniformBuffer<ClusterData> m_uniforms;
+    ClusterData m_data;
+    glm::mat4 m_projection = glm::mat4(1.0f);
+    float m_near = 0.0f;
+    float m_far = 0.0f;
+    unsigned int m_width = 0;
+    unsigned int m_height = 0;
+    bool m_has_projection = false;
+    bool m_overflow_reported = false;
+
+    std::vector<detail::ClusterBox> m_boxes;
+    std::vector<detail::LightSlice> m_slices;
+
+    //svetla u prostoru kamere, po komponentama
+    std::vector<float> m_x, m_y, m_depth, m_radius;
+    std::vector<glm::vec4> m_light_data;
+    std::vector<uint32_t> m_ranges;
+    std::vector<uint16_t> m_indices;
+    std::vector<uint8_t> m_visible;
+    size_t m_visible_count = 0;
+
+    unsigned int m_buffers[BUFFER_COUNT] = {0, 0, 0};
+    unsigned int m_textures[BUFFER_COUNT] = {0, 0, 0};
+
+    static unsigned int clusterIndex(unsigned int x, unsigned int y, unsigned int z) {
+        return x + GRID_X * (y + GRID_Y * z);
+    }
+
+    void binSlices(unsigned int begin, unsigned int end) {
+        for (unsigned int z = begin; z < end; z++) {
+            detail::LightSlice& slice = m_slices[z];
+            const detail::ClusterBox& first = m_boxes[clusterIndex(0, 0, z)];
+
+            //samo svetla koja dosezu dubine preseka ulaze u test sa njegovim klasterima
+            slice.m_x.clear();
+            slice.m_y.clear();
+            slice.m_depth.clear();
+            slice.m_radius.clear();
+            slice.m_light.clear();
+            for (size_t i = 0; i < m_depth.size(); i++) {
+                if (m_depth[i] + m_radius[i] >= first.m_near && m_depth[i] - m_radius[i] <= first.m_far) {
+                    slice.m_x.push_back(m_x[i]);
+                    slice.m_y.push_back(m_y[i]);
+                    slice.m_depth.push_back(m_depth[i]);
+                    slice.m_radius.push_back(m_radius[i]);
+                    slice.m_light.push_back((uint16_t) i);
+                }
+            }
+
+            //pocetak liste je za sada relativan prema listama preseka
+            slice.m_indices.clear();
+            for (unsigned int tile = 0; tile < TILE_COUNT; tile++) {
+                unsigned int cluster = z * TILE_COUNT + tile;
+                size_t offset = slice.m_indices.size();
+                if (!slice.m_light.empty()) {
+                    detail::binCluster(slice, m_boxes[cluster], slice.m_indices);
+                }
+                m_ranges[2 * cluster] = (uint32_t) offset;
+                m_ranges[2 * cluster + 1] = (uint32_t) (slice.m_indices.size() - offset);
+            }
+        }
+    }
+
+    //bafer se pravi ponovo svakog frejma (GL_STREAM_DRAW), pa drajver ne ceka GPU koji jos cita prethodni
+    //prazan bafer dobija jedan element, da tekstura uvek ima skladiste
+    void upload(unsigned int index, GLenum format, const void* data, size_t bytes) {
+        const uint32_t empty[4] = {0, 0, 0, 0};
+        if (bytes == 0) {
+            data = empty;
+            bytes = sizeof(empty);
+        }
+
+        bool created = m_textures[index] == 0;
+        if (created) {
+            glGenBuffers(1, &m_buffers[index]);
+            glGenTextures(1, &m_textures[index]);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, m_buffers[index]);
+        glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr) bytes, data, GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        //tekstura ostaje vezana za bafer i kad mu se skladiste zameni
+        if (created) {
+            glBindTexture(GL_TEXTURE_BUFFER, m_textures[index]);
+            glTexBuffer(GL_TEXTURE_BUFFER, format, m_buffers[index]);
+            glBindTexture(GL_TEXTURE_BUFFER, 0);
+        }
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_CLUSTEREDLIGHTS_H
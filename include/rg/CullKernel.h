@@ -0,0 +1,272 @@
+#ifndef PROJECT_BASE_CULLKERNEL_H
+#define PROJECT_BASE_CULLKERNEL_H
+
+#include <glm/glm.hpp>
+
+#include <rg/Bounds.h>
+#include <rg/Frustum.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+//SSE2 je deo x86-64, AVX2 se bira tek posle provere procesora u toku rada
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RG_CULL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace rg {
+
+//granice mnogo objekata po komponentama (structure of arrays), da bi SIMD kernel citao 4 ili 8 objekata odjednom
+//svaki objekat ima AABB u obliku centar-poluosa i sferu
+class BoundsStore {
+public:
+    size_t size() const {
+        return m_radius.size();
+    }
+
+    void clear() {
+        for (std::vector<float>* component : components()) {
+            component->clear();
+        }
+    }
+
+    void reserve(size_t count) {
+        for (std::vector<float>* component : components()) {
+            component->reserve(count);
+        }
+    }
+
+    size_t add(const AABB& box, const Sphere& sphere) {
+        for (std::vector<float>* component : components()) {
+            component->push_back(0.0f);
+        }
+        set(size() - 1, box, sphere);
+        return size() - 1;
+    }
+
+    void set(size_t index, const AABB& box, const Sphere& sphere) {
+        glm::vec3 center = box.center();
+        glm::vec3 extents = box.extents();
+        m_box_x[index] = center.x;
+        m_box_y[index] = center.y;
+        m_box_z[index] = center.z;
+        m_extent_x[index] = extents.x;
+        m_extent_y[index] = extents.y;
+        m_extent_z[index] = extents.z;
+        m_sphere_x[index] = sphere.m_center.x;
+        m_sphere_y[index] = sphere.m_center.y;
+        m_sphere_z[index] = sphere.m_center.z;
+        m_radius[index] = sphere.m_radius;
+    }
+
+    std::vector<float> m_box_x, m_box_y, m_box_z;
+    std::vector<float> m_extent_x, m_extent_y, m_extent_z;
+    std::vector<float> m_sphere_x, m_sphere_y, m_sphere_z, m_radius;
+
+private:
+    std::vector<std::vector<float>*> components() {
+        return {&m_box_x, &m_box_y, &m_box_z, &m_extent_x, &m_extent_y, &m_extent_z,
+                &m_sphere_x, &m_sphere_y, &m_sphere_z, &m_radius};
+    }
+};
+
+enum class CullKernel {
+    Scalar,
+    SSE,
+    AVX2
+};
+
+inline const char* cullKernelName(CullKernel kernel) {
+    switch (kernel) {
+        case CullKernel::Scalar: return "scalar";
+        case CullKernel::SSE: return "SSE";
+        case CullKernel::AVX2: return "AVX2";
+    }
+    return "?";
+}
+
+//najbrzi kernel koji procesor podrzava, odredjuje se jednom
+inline CullKernel bestCullKernel() {
+#ifdef RG_CULL_X86
+    static const CullKernel kernel = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")
+                                     ? CullKernel::AVX2 : CullKernel::SSE;
+    return kernel;
+#else
+    return CullKernel::Scalar;
+#endif
+}
+
+namespace detail {
+
+//objekat je vidljiv ako nije ceo iza neke od sest ravni
+//sfera: dot(n, c) + w >= -r; kvadar: dot(n, c) + w >= -dot(|n|, e)
+inline size_t cullScalar(const BoundsStore& bounds, const Frustum& frustum, bool spheres,
+                         size_t begin, size_t end, uint8_t* visible) {
+    const float* x = spheres ? bounds.m_sphere_x.data() : bounds.m_box_x.data();
+    const float* y = spheres ? bounds.m_sphere_y.data() : bounds.m_box_y.data();
+    const float* z = spheres ? bounds.m_sphere_z.data() : bounds.m_box_z.data();
+    size_t count = 0;
+    for (size_t i = begin; i < end; i++) {
+        bool inside = true;
+        for (const glm::vec4& plane : frustum.m_planes) {
+            float distance = plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w;
+            float reach = spheres ? bounds.m_radius[i]
+                                  : std::fabs(plane.x) * bounds.m_extent_x[i] + std::fabs(plane.y) * bounds.m_extent_y[i]
+                                    + std::fabs(plane.z) * bounds.m_extent_z[i];
+            inside &= distance + reach >= 0.0f;
+        }
+        visible[i] = inside ? 1 : 0;
+        count += inside;
+    }
+    return count;
+}
+
+#ifdef RG_CULL_X86
+
+//4 objekta po iteraciji; vraca broj obradjenih objekata, ostatak obradjuje skalarni kernel
+template <bool spheres>
+inline size_t cullSse(const BoundsStore& bounds, const Frustum& frustum, uint8_t* visible, size_t& count) {
+    const float* x = spheres ? bounds.m_sphere_x.data() : bounds.m_box_x.data();
+    const float* y = spheres ? bounds.m_sphere_y.data() : bounds.m_box_y.data();
+    const float* z = spheres ? bounds.m_sphere_z.data() : bounds.m_box_z.data();
+
+    __m128 plane_x[Frustum::PlaneCount], plane_y[Frustum::PlaneCount], plane_z[Frustum::PlaneCount], plane_w[Frustum::PlaneCount];
+    __m128 abs_x[Frustum::PlaneCount], abs_y[Frustum::PlaneCount], abs_z[Frustum::PlaneCount];
+    for (int p = 0; p < Frustum::PlaneCount; p++) {
+        const glm::vec4& plane = frustum.m_planes[p];
+        plane_x[p] = _mm_set1_ps(plane.x);
+        plane_y[p] = _mm_set1_ps(plane.y);
+        plane_z[p] = _mm_set1_ps(plane.z);
+        plane_w[p] = _mm_set1_ps(plane.w);
+        abs_x[p] = _mm_set1_ps(std::fabs(plane.x));
+        abs_y[p] = _mm_set1_ps(std::fabs(plane.y));
+        abs_z[p] = _mm_set1_ps(std::fabs(plane.z));
+    }
+
+    size_t n = bounds.size() & ~(size_t) 3;
+    const __m128 zero = _mm_setzero_ps();
+    for (size_t i = 0; i < n; i += 4) {
+        __m128 cx = _mm_loadu_ps(x + i);
+        __m128 cy = _mm_loadu_ps(y + i);
+        __m128 cz = _mm_loadu_ps(z + i);
+        __m128 ex = zero, ey = zero, ez = zero, radius = zero;
+        if (spheres) {
+            radius = _mm_loadu_ps(bounds.m_radius.data() + i);
+        } else {
+            ex = _mm_loadu_ps(bounds.m_extent_x.data() + i);
+            ey = _mm_loadu_ps(bounds.m_extent_y.data() + i);
+            ez = _mm_loadu_ps(bounds.m_extent_z.data() + i);
+        }
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < Frustum::PlaneCount; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_x[p], cx), _mm_mul_ps(plane_y[p], cy)),
+                                         _mm_add_ps(_mm_mul_ps(plane_z[p], cz), plane_w[p]));
+            __m128 reach = spheres ? radius
+                                   : _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_x[p], ex), _mm_mul_ps(abs_y[p], ey)),
+                                                _mm_mul_ps(abs_z[p], ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, reach), zero));
+        }
+
+        //maske -1/0 u bajtove 1/0
+        __m128i bytes = _mm_and_si128(_mm_castps_si128(inside), _mm_set1_epi32(1));
+        bytes = _mm_packus_epi16(_mm_packs_epi32(bytes, bytes), bytes);
+        int packed = _mm_cvtsi128_si32(bytes);
+        std::memcpy(visible + i, &packed, 4);
+        count += __builtin_popcount(_mm_movemask_ps(inside));
+    }
+    return n;
+}
+
+//8 objekata po iteraciji, FMA za skalarne proizvode; prevodi se za AVX2 bez obzira na flegove ostatka programa
+template <bool spheres>
+__attribute__((target("avx2,fma")))
+inline size_t cullAvx2(const BoundsStore& bounds, const Frustum& frustum, uint8_t* visible, size_t& count) {
+    const float* x = spheres ? bounds.m_sphere_x.data() : bounds.m_box_x.data();
+    const float* y = spheres ? bounds.m_sphere_y.data() : bounds.m_box_y.data();
+    const float* z = spheres ? bounds.m_sphere_z.data() : bounds.m_box_z.data();
+
+    __m256 plane_x[Frustum::PlaneCount], plane_y[Frustum::PlaneCount], plane_z[Frustum::PlaneCount], plane_w[Frustum::PlaneCount];
+    __m256 abs_x[Frustum::PlaneCount], abs_y[Frustum::PlaneCount], abs_z[Frustum::PlaneCount];
+    for (int p = 0; p < Frustum::PlaneCount; p++) {
+        const glm::vec4& plane = frustum.m_planes[p];
+        plane_x[p] = _mm256_set1_ps(plane.x);
+        plane_y[p] = _mm256_set1_ps(plane.y);
+        plane_z[p] = _mm256_set1_ps(plane.z);
+        plane_w[p] = _mm256_set1_ps(plane.w);
+        abs_x[p] = _mm256_set1_ps(std::fabs(plane.x));
+        abs_y[p] = _mm256_set1_ps(std::fabs(plane.y));
+        abs_z[p] = _mm256_set1_ps(std::fabs(plane.z));
+    }
+
+    size_t n = bounds.size() & ~(size_t) 7;
+    const __m256 zero = _mm256_setzero_ps();
+    for (size_t i = 0; i < n; i += 8) {
+        __m256 cx = _mm256_loadu_ps(x + i);
+        __m256 cy = _mm256_loadu_ps(y + i);
+        __m256 cz = _mm256_loadu_ps(z + i);
+        __m256 ex = zero, ey = zero, ez = zero, radius = zero;
+        if (spheres) {
+            radius = _mm256_loadu_ps(bounds.m_radius.data() + i);
+        } else {
+            ex = _mm256_loadu_ps(bounds.m_extent_x.data() + i);
+            ey = _mm256_loadu_ps(bounds.m_extent_y.data() + i);
+            ez = _mm256_loadu_ps(bounds.m_extent_z.data() + i);
+        }
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < Frustum::PlaneCount; p++) {
+            __m256 distance = _mm256_fmadd_ps(plane_x[p], cx, _mm256_fmadd_ps(plane_y[p], cy, _mm256_fmadd_ps(plane_z[p], cz, plane_w[p])));
+            __m256 reach = spheres ? radius
+                                   : _mm256_fmadd_ps(abs_x[p], ex, _mm256_fmadd_ps(abs_y[p], ey, _mm256_mul_ps(abs_z[p], ez)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), zero, _CMP_GE_OQ));
+        }
+
+        __m256i ones = _mm256_and_si256(_mm256_castps_si256(inside), _mm256_set1_epi32(1));
+        __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(ones), _mm256_extracti128_si256(ones, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(visible + i), _mm_packus_epi16(words, words));
+        count += __builtin_popcount(_mm256_movemask_ps(inside));
+    }
+    return n;
+}
+
+#endif
+
+inline size_t cull(const BoundsStore& bounds, const Frustum& frustum, bool spheres, uint8_t* visible, CullKernel kernel) {
+    size_t count = 0;
+    size_t done = 0;
+#ifdef RG_CULL_X86
+    //trazeni AVX2 na procesoru bez njega pada na SSE umesto na nedozvoljenu instrukciju
+    if (kernel == CullKernel::AVX2 && bestCullKernel() != CullKernel::AVX2) {
+        kernel = CullKernel::SSE;
+    }
+    if (kernel == CullKernel::AVX2) {
+        done = spheres ? cullAvx2<true>(bounds, frustum, visible, count) : cullAvx2<false>(bounds, frustum, visible, count);
+    } else if (kernel == CullKernel::SSE) {
+        done = spheres ? cullSse<true>(bounds, frustum, visible, count) : cullSse<false>(bounds, frustum, visible, count);
+    }
+#endif
+    return count + cullScalar(bounds, frustum, spheres, done, bounds.size(), visible);
+}
+
+}
+
+//upisuje 1 ili 0 u visible[i] za svaku sferu iz bounds i vraca broj vidljivih
+inline size_t cullSpheres(const BoundsStore& bounds, const Frustum& frustum, uint8_t* visible,
+                          CullKernel kernel = bestCullKernel()) {
+    return detail::cull(bounds, frustum, true, visible, kernel);
+}
+
+//isto za AABB-ove; test je konzervativan kao Frustum::intersects(AABB)
+inline size_t cullBoxes(const BoundsStore& bounds, const Frustum& frustum, uint8_t* visible,
+                        CullKernel kernel = bestCullKernel()) {
+    return detail::cull(bounds, frustum, false, visible, kernel);
+}
+
+}
+
+#endif //PROJECT_BASE_CULLKERNEL_H
@@ -0,0 +1,182 @@
+#ifndef PROJECT_BASE_FRAMESTATS_H
+#define PROJECT_BASE_FRAMESTATS_H
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+namespace rg {
+
+//brojaci jednog frejma
+struct FrameCounters {
+    size_t m_draw_calls = 0;
+    size_t m_triangles = 0;
+    size_t m_visible = 0; // instance modela koje su prosle frustum test
+    size_t m_culled = 0;  // instance modela odbacene frustum testom
+    size_t m_state_changes = 0; // vezivanja programa, VAO-a, bafera i tekstura poslata GL-u
+    size_t m_state_skipped = 0; // ponovljena vezivanja koja je kes stanja preskocio
+    size_t m_uniform_uploads = 0; // slanja uniform buffer-a
+    size_t m_uniform_bytes = 0;
+    size_t m_indirect_commands = 0; // komande izvrsene kroz glMultiDrawElementsIndirect
+    size_t m_lights = 0; // svetla rasporedjena u klastere
+    size_t m_light_references = 0; // zbir duzina lista svetala svih klastera
+    double m_light_binning_ms = 0.0;
+    size_t m_occlusion_queries = 0; // upiti zaklonjenosti postavljeni u frejmu
+    size_t m_occluded = 0; // objekti u piramidi pogleda koje je upit proglasio zaklonjenim
+    size_t m_occlusion_conditional = 0; // objekti o kojima odlucuje GPU, jer im upit nije gotov
+    std::vector<size_t> m_lod_draws;
+};
+
+//brojaci poziva crtanja, trouglova i odbacenih objekata po frejmu, ispisuju se kao prosek jednom u sekundi
+//koristi se samo sa GL niti
+class FrameStats {
+public:
+    static FrameStats& instance() {
+        static FrameStats stats;
+        return stats;
+    }
+
+    void recordDraw(size_t triangles, unsigned int lod = 0) {
+        m_frame.m_draw_calls++;
+        recordGeometry(triangles, lod);
+    }
+
+    //jedan glMultiDrawElementsIndirect je jedan poziv crtanja, njegove komande se broje posebno
+    void recordMultiDraw(size_t commands) {
+        m_frame.m_draw_calls++;
+        m_frame.m_indirect_commands += commands;
+    }
+
+    //trouglovi i nivo detalja jedne indirektne komande
+    void recordIndirectCommand(size_t triangles, unsigned int lod) {
+        recordGeometry(triangles, lod);
+    }
+
+    void recordCulling(size_t visible, size_t culled) {
+        m_frame.m_visible += visible;
+        m_frame.m_culled += culled;
+    }
+
+    void recordStateChanges(size_t changes, size_t skipped) {
+        m_frame.m_state_changes += changes;
+        m_frame.m_state_skipped += skipped;
+    }
+
+    void recordUniformUpload(size_t bytes) {
+        m_frame.m_uniform_uploads++;
+        m_frame.m_uniform_bytes += bytes;
+    }
+
+    void recordLightBinning(size_t lights, size_t references, double ms) {
+        m_frame.m_lights += lights;
+        m_frame.m_light_references += references;
+        m_frame.m_light_binning_ms += ms;
+    }
+
+    void recordOcclusion(size_t queries, size_t occluded, size_t conditional) {
+        m_frame.m_occlusion_queries += queries;
+        m_frame.m_occluded += occluded;
+        m_frame.m_occlusion_conditional += conditional;
+    }
+
+    //brojaci frejma koji je u toku i poslednjeg zavrsenog frejma
+    const FrameCounters& current() const {
+        return m_frame;
+    }
+
+    const FrameCounters& last() const {
+        return m_last;
+    }
+
+    //zatvara frejm; time je vreme u sekundama od pocetka programa
+    void endFrame(double time, std::ostream& out = std::cout) {
+        accumulate(m_frame);
+        m_last = m_frame;
+        m_frame = FrameCounters();
+
+        m_frames++;
+        if (m_interval_start < 0.0) {
+            m_interval_start = time;
+        }
+        double elapsed = time - m_interval_start;
+        if (elapsed < m_report_interval) {
+            return;
+        }
+
+        out << "FPS " << m_frames / elapsed
+            << " | po frejmu: " << m_interval.m_draw_calls / m_frames << " poziva crtanja";
+        if (m_interval.m_indirect_commands > 0) {
+            out << " (" << m_interval.m_indirect_commands / m_frames << " indirektnih komandi)";
+        }
+        out << ", "
+            << m_interval.m_triangles / m_frames << " trouglova, "
+            << m_interval.m_state_changes / m_frames << " promena stanja (" << m_interval.m_state_skipped / m_frames << " preskoceno), "
+            << (double) m_interval.m_uniform_uploads / m_frames << " UBO slanja, "
+            << m_interval.m_visible / m_frames << " vidljivih / " << m_interval.m_culled / m_frames << " odbacenih | LOD";
+        for (size_t i = 0; i < m_interval.m_lod_draws.size(); i++) {
+            out << (i == 0 ? " " : "/") << m_interval.m_lod_draws[i] / m_frames;
+        }
+        if (m_interval.m_lights > 0) {
+            out << " | svetla: " << m_interval.m_lights / m_frames << " u klasterima, "
+                << m_interval.m_light_references / m_frames << " referenci, "
+                << m_interval.m_light_binning_ms / m_frames << " ms raspodele";
+        }
+        if (m_interval.m_occlusion_queries > 0 || m_interval.m_occluded > 0) {
+            out << " | zaklonjeno: " << m_interval.m_occluded / m_frames << " objekata, "
+                << m_interval.m_occlusion_conditional / m_frames << " uslovno, "
+                << m_interval.m_occlusion_queries / m_frames << " upita";
+        }
+        out << "\n";
+
+        m_interval_start = time;
+        m_frames = 0;
+        m_interval = FrameCounters();
+    }
+
+    double m_report_interval = 1.0;
+
+private:
+    FrameStats() = default;
+
+    void recordGeometry(size_t triangles, unsigned int lod) {
+        m_frame.m_triangles += triangles;
+        if (m_frame.m_lod_draws.size() <= lod) {
+            m_frame.m_lod_draws.resize(lod + 1, 0);
+        }
+        m_frame.m_lod_draws[lod]++;
+    }
+
+    void accumulate(const FrameCounters& frame) {
+        m_interval.m_draw_calls += frame.m_draw_calls;
+        m_interval.m_triangles += frame.m_triangles;
+        m_interval.m_visible += frame.m_visible;
+        m_interval.m_culled += frame.m_culled;
+        m_interval.m_state_changes += frame.m_state_changes;
+        m_interval.m_state_skipped += frame.m_state_skipped;
+        m_interval.m_uniform_uploads += frame.m_uniform_uploads;
+        m_interval.m_uniform_bytes += frame.m_uniform_bytes;
+        m_interval.m_indirect_commands += frame.m_indirect_commands;
+        m_interval.m_lights += frame.m_lights;
+        m_interval.m_light_references += frame.m_light_references;
+        m_interval.m_light_binning_ms += frame.m_light_binning_ms;
+        m_interval.m_occlusion_queries += frame.m_occlusion_queries;
+        m_interval.m_occluded += frame.m_occluded;
+        m_interval.m_occlusion_conditional += frame.m_occlusion_conditional;
+        if (m_interval.m_lod_draws.size() < frame.m_lod_draws.size()) {
+            m_interval.m_lod_draws.resize(frame.m_lod_draws.size(), 0);
+        }
+        for (size_t i = 0; i < frame.m_lod_draws.size(); i++) {
+            m_interval.m_lod_draws[i] += frame.m_lod_draws[i];
+        }
+    }
+
+    FrameCounters m_frame;
+    FrameCounters m_last;
+    FrameCounters m_interval;
+    double m_interval_start = -1.0;
+    size_t m_frames = 0;
+};
+
+}
+
+#endif //PROJECT_BASE_FRAMESTATS_H
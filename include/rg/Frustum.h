@@ -0,0 +1,70 @@
+#ifndef PROJECT_BASE_FRUSTUM_H
+#define PROJECT_BASE_FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <rg/Bounds.h>
+
+namespace rg {
+
+//sest ravni piramide pogleda sa normalama ka unutra, u prostoru sveta
+//tacka p je unutar ravni kada je dot(plane.xyz, p) + plane.w >= 0
+struct Frustum {
+    enum Plane { Left = 0, Right, Bottom, Top, Near, Far, PlaneCount };
+
+    glm::vec4 m_planes[PlaneCount];
+
+    //izdvajanje ravni iz projection * view matrice (Gribb-Hartmann)
+    static Frustum fromMatrix(const glm::mat4& view_projection) {
+        //glm matrice su po kolonama, pa se redovi sastavljaju rucno
+        glm::vec4 rows[4];
+        for (int row = 0; row < 4; row++) {
+            rows[row] = glm::vec4(view_projection[0][row], view_projection[1][row],
+                                  view_projection[2][row], view_projection[3][row]);
+        }
+
+        Frustum frustum;
+        frustum.m_planes[Left] = rows[3] + rows[0];
+        frustum.m_planes[Right] = rows[3] - rows[0];
+        frustum.m_planes[Bottom] = rows[3] + rows[1];
+        frustum.m_planes[Top] = rows[3] - rows[1];
+        frustum.m_planes[Near] = rows[3] + rows[2];
+        frustum.m_planes[Far] = rows[3] - rows[2];
+
+        //normalizovane ravni daju prava rastojanja, potrebna za test sfere
+        for (glm::vec4& plane : frustum.m_planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return frustum;
+    }
+
+    bool intersects(const Sphere& sphere) const {
+        for (const glm::vec4& plane : m_planes) {
+            if (glm::dot(glm::vec3(plane), sphere.m_center) + plane.w < -sphere.m_radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //konzervativan test: kvadar je odbacen samo ako je ceo iza neke ravni
+    bool intersects(const AABB& box) const {
+        if (!box.isValid()) {
+            return false;
+        }
+        for (const glm::vec4& plane : m_planes) {
+            //teme kvadra najdalje u smeru normale ravni
+            glm::vec3 positive(plane.x >= 0.0f ? box.m_max.x : box.m_min.x,
+                               plane.y >= 0.0f ? box.m_max.y : box.m_min.y,
+                               plane.z >= 0.0f ? box.m_max.z : box.m_min.z);
+            if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_FRUSTUM_H
@@ -0,0 +1,28 @@
+#ifndef PROJECT_BASE_GLCAPABILITIES_H
+#define PROJECT_BASE_GLCAPABILITIES_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <unordered_set>
+
+namespace rg {
+
+//da li trenutni kontekst podrzava dato prosirenje; lista se cita jednom, posle inicijalizacije GLAD-a
+inline bool hasGLExtension(const std::string& name) {
+    static std::unordered_set<std::string> extensions;
+    static bool queried = false;
+    if (!queried) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            extensions.insert(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, (GLuint) i)));
+        }
+        queried = true;
+    }
+    return extensions.count(name) > 0;
+}
+
+}
+
+#endif //PROJECT_BASE_GLCAPABILITIES_H
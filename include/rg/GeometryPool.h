@@ -0,0 +1,422 @@
+#ifndef PROJECT_BASE_GEOMETRYPOOL_H
+#define PROJECT_BASE_GEOMETRYPOOL_H
+
+#include <glad/glad.h>
+
+#include <rg/VertexLayout.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <vector>
+
+namespace rg {
+
+//slobodni opsezi jednog bafera (pomeraj -> velicina) u proizvoljnim jedinicama
+//zauzima se najmanji opseg u koji zahtev staje, a susedni slobodni opsezi se spajaju pri oslobadjanju
+class RangeAllocator {
+public:
+    static const size_t NO_SPACE = ~(size_t) 0;
+
+    //pomeraj zauzetog opsega ili NO_SPACE; prazan opseg je uvek uspesan i ne zauzima nista
+    size_t allocate(size_t size) {
+        if (size == 0)
+            return 0;
+        auto best = m_free.end();
+        for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+            if (it->second >= size && (best == m_free.end() || it->second < best->second)) {
+                best = it;
+                if (best->second == size)
+                    break;
+            }
+        }
+        if (best == m_free.end())
+            return NO_SPACE;
+
+        size_t offset = best->first;
+        size_t remaining = best->second - size;
+        m_free.erase(best);
+        if (remaining > 0) {
+            m_free[offset + size] = remaining;
+        }
+        m_free_size -= size;
+        return offset;
+    }
+
+    void free(size_t offset, size_t size) {
+        if (size == 0)
+            return;
+        m_free_size += size;
+        auto next = m_free.lower_bound(offset);
+        if (next != m_free.end() && offset + size == next->first) {
+            size += next->second;
+            next = m_free.erase(next);
+        }
+        if (next != m_free.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == offset) {
+                previous->second += size;
+                return;
+            }
+        }
+        m_free[offset] = size;
+    }
+
+    //novi prostor na kraju bafera postaje slobodan
+    void grow(size_t capacity) {
+        size_t old_capacity = m_capacity;
+        m_capacity = capacity;
+        free(old_capacity, capacity - old_capacity);
+    }
+
+    //posle sabijanja: zauzeto je prvih used jedinica, ostatak je jedan slobodan opseg
+    void reset(size_t capacity, size_t used) {
+        m_free.clear();
+        m_capacity = capacity;
+        m_free_size = 0;
+        free(used, capacity - used);
+    }
+
+    size_t capacity() const {
+        return m_capacity;
+    }
+
+    size_t freeSize() const {
+        return m_free_size;
+    }
+
+    size_t largestBlock() const {
+        size_t largest = 0;
+        for (const auto& block : m_free) {
+            largest = std::max(largest, block.second);
+        }
+        return largest;
+    }
+
+    size_t blocks() const {
+        return m_free.size();
+    }
+
+private:
+    std::map<size_t, size_t> m_free;
+    size_t m_capacity = 0;
+    size_t m_free_size = 0;
+};
+
+//zajednicki baferi geometrije: za svaki format verteksa jedan VBO, jedan EBO i jedan VAO koje dele svi mesh-evi tog formata
+//mesh dobija opseg verteksa i opseg indeksa, a crta se sa glDrawElementsBaseVertex, pa indeksi ostaju lokalni za mesh
+//kad zahtev ne stane ni u jedan slobodan opseg, a ukupno slobodnog mesta ima dovoljno, baferi formata se sabijaju;
+//inace se udvostrucuju; oba se rade kopiranjem na GPU-u, pa geometrija ne mora da ostane u RAM-u
+//koristi se samo sa GL niti; GL objekti se brisu kroz release(), dok kontekst jos postoji
+class GeometryPool {
+public:
+    typedef uint32_t Handle;
+    static const Handle INVALID_HANDLE = ~(Handle) 0;
+
+    //opseg jednog mesh-a u baferima njegovog formata
+    struct Allocation {
+        VertexFormat m_format;
+        size_t m_vertex_offset; // u verteksima
+        size_t m_vertex_count;
+        size_t m_index_offset;  // u bajtovima, deljiv sa 4 da bi odgovarao i 16-bitnim i 32-bitnim indeksima
+        size_t m_index_bytes;
+        bool m_live;
+    };
+
+    static GeometryPool& instance() {
+        static GeometryPool pool;
+        return pool;
+    }
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    //verteksi su vec u formatu format, indeksi u sirini koju ce mesh koristiti pri crtanju
+    Handle allocate(VertexFormat format, const void* vertices, size_t vertex_count, const void* indices, size_t index_bytes) {
+        FormatBuffers& buffers = m_formats[(size_t) format];
+        if (buffers.m_vertex_array == 0) {
+            glGenVertexArrays(1, &buffers.m_vertex_array);
+            buffers.m_vertex_size = vertexSize(format);
+        }
+
+        size_t index_space = (index_bytes + 3) & ~(size_t) 3;
+        makeRoom(format, vertex_count, index_space);
+
+        Allocation allocation;
+        allocation.m_format = format;
+        allocation.m_vertex_offset = buffers.m_vertices.allocate(vertex_count);
+        allocation.m_vertex_count = vertex_count;
+        allocation.m_index_offset = buffers.m_indices.allocate(index_space);
+        allocation.m_index_bytes = index_space;
+        allocation.m_live = true;
+
+        //prazan mesh ne dobija prostor, a baferi formata mogu jos da ne postoje
+        if (vertex_count > 0) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffers.m_vertex_buffer);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.m_vertex_offset * buffers.m_vertex_size,
+                            vertex_count * buffers.m_vertex_size, vertices);
+        }
+        if (index_bytes > 0) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffers.m_index_buffer);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.m_index_offset, index_bytes, indices);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        Handle handle;
+        if (!m_free_handles.empty()) {
+            handle = m_free_handles.back();
+            m_free_handles.pop_back();
+            m_allocations[handle] = allocation;
+        } else {
+            handle = (Handle) m_allocations.size();
+            m_allocations.push_back(allocation);
+        }
+        return handle;
+    }
+
+    //posle release-a svi stari handle-ovi su vec oslobodjeni, pa se ignorisu
+    void free(Handle handle) {
+        if (handle >= m_allocations.size() || !m_allocations[handle].m_live)
+            return;
+        Allocation& allocation = m_allocations[handle];
+        FormatBuffers& buffers = m_formats[(size_t) allocation.m_format];
+        buffers.m_vertices.free(allocation.m_vertex_offset, allocation.m_vertex_count);
+        buffers.m_indices.free(allocation.m_index_offset, allocation.m_index_bytes);
+        allocation.m_live = false;
+        m_free_handles.push_back(handle);
+    }
+
+    //pomeraji se menjaju pri sabijanju, pa se citaju pri svakom crtanju
+    const Allocation& allocation(Handle handle) const {
+        return m_allocations[handle];
+    }
+
+    //VAO formata sa vezanim VBO-om i EBO-om; 0 dok prvi mesh tog formata ne bude dodat
+    unsigned int vertexArray(VertexFormat format) const {
+        return m_formats[(size_t) format].m_vertex_array;
+    }
+
+    //zivi opsezi se kopiraju redom na pocetak novih bafera iste velicine, pa ostaje jedan slobodan opseg na kraju
+    void defragment(VertexFormat format) {
+        FormatBuffers& buffers = m_formats[(size_t) format];
+        if (buffers.m_vertex_array == 0)
+            return;
+
+        std::vector<Allocation*> live;
+        for (Allocation& allocation : m_allocations) {
+            if (allocation.m_live && allocation.m_format == format) {
+                live.push_back(&allocation);
+            }
+        }
+
+        std::sort(live.begin(), live.end(), [](const Allocation* a, const Allocation* b) {
+            return a->m_vertex_offset < b->m_vertex_offset;
+        });
+        unsigned int vertex_buffer = createBuffer(buffers.m_vertices.capacity() * buffers.m_vertex_size);
+        size_t vertex_end = 0;
+        glBindBuffer(GL_COPY_READ_BUFFER, buffers.m_vertex_buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vertex_buffer);
+        for (Allocation* allocation : live) {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation->m_vertex_offset * buffers.m_vertex_size,
+                                vertex_end * buffers.m_vertex_size, allocation->m_vertex_count * buffers.m_vertex_size);
+            allocation->m_vertex_offset = vertex_end;
+            vertex_end += allocation->m_vertex_count;
+        }
+
+        std::sort(live.begin(), live.end(), [](const Allocation* a, const Allocation* b) {
+            return a->m_index_offset < b->m_index_offset;
+        });
+        unsigned int index_buffer = createBuffer(buffers.m_indices.capacity());
+        size_t index_end = 0;
+        glBindBuffer(GL_COPY_READ_BUFFER, buffers.m_index_buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, index_buffer);
+        for (Allocation* allocation : live) {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation->m_index_offset, index_end,
+                                allocation->m_index_bytes);
+            allocation->m_index_offset = index_end;
+            index_end += allocation->m_index_bytes;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glDeleteBuffers(1, &buffers.m_vertex_buffer);
+        glDeleteBuffers(1, &buffers.m_index_buffer);
+        buffers.m_vertex_buffer = vertex_buffer;
+        buffers.m_index_buffer = index_buffer;
+        buffers.m_vertices.reset(buffers.m_vertices.capacity(), vertex_end);
+        buffers.m_indices.reset(buffers.m_indices.capacity(), index_end);
+        setupVertexArray(format);
+        m_defragmentations++;
+    }
+
+    //brise sve GL objekte; mesh-evi napravljeni pre toga vise ne smeju da se crtaju
+    void release() {
+        for (size_t i = 0; i < FORMAT_COUNT; i++) {
+            FormatBuffers& buffers = m_formats[i];
+            if (buffers.m_vertex_array != 0) {
+                glDeleteVertexArrays(1, &buffers.m_vertex_array);
+                glDeleteBuffers(1, &buffers.m_vertex_buffer);
+                glDeleteBuffers(1, &buffers.m_index_buffer);
+            }
+            buffers = FormatBuffers();
+        }
+        m_allocations.clear();
+        m_free_handles.clear();
+    }
+
+    void printStats(std::ostream& out) const {
+        const char* names[FORMAT_COUNT] = {"Full", "Packed", "PackedTangent", "PackedWideUv", "PackedTangentWideUv"};
+        out << "Geometrija na GPU-u: " << m_allocations.size() - m_free_handles.size() << " mesh-eva, "
+            << m_defragmentations << " sabijanja, " << m_grows << " prosirenja\n";
+        for (size_t i = 0; i < FORMAT_COUNT; i++) {
+            const FormatBuffers& buffers = m_formats[i];
+            if (buffers.m_vertex_array == 0)
+                continue;
+            size_t vertex_capacity = buffers.m_vertices.capacity() * buffers.m_vertex_size;
+            size_t vertex_used = vertex_capacity - buffers.m_vertices.freeSize() * buffers.m_vertex_size;
+            out << "  " << names[i] << ": verteksi " << vertex_used / 1024 << "/" << vertex_capacity / 1024
+                << " KB (" << buffers.m_vertices.blocks() << " slobodnih opsega), indeksi "
+                << (buffers.m_indices.capacity() - buffers.m_indices.freeSize()) / 1024 << "/"
+                << buffers.m_indices.capacity() / 1024 << " KB (" << buffers.m_indices.blocks() << " slobodnih opsega)\n";
+        }
+    }
+
+private:
+    static const size_t FORMAT_COUNT = 5;
+
+    //pocetni kapaciteti, u verteksima i bajtovima indeksa
+    static const size_t INITIAL_VERTICES = 64 * 1024;
+    static const size_t INITIAL_INDEX_BYTES = 256 * 1024;
+
+    struct FormatBuffers {
+        unsigned int m_vertex_array = 0;
+        unsigned int m_vertex_buffer = 0;
+        unsigned int m_index_buffer = 0;
+        size_t m_vertex_size = 0;
+        RangeAllocator m_vertices; // u verteksima
+        RangeAllocator m_indices;  // u bajtovima
+    };
+
+    FormatBuffers m_formats[FORMAT_COUNT];
+    std::vector<Allocation> m_allocations;
+    std::vector<Handle> m_free_handles;
+    size_t m_defragmentations = 0;
+    size_t m_grows = 0;
+
+    GeometryPool() = default;
+
+    static size_t vertexSize(VertexFormat format) {
+        switch (format) {
+            case VertexFormat::Full:
+                return sizeof(Vertex);
+            case VertexFormat::Packed:
+                return sizeof(PackedVertex);
+            case VertexFormat::PackedTangent:
+                return sizeof(PackedTangentVertex);
+            case VertexFormat::PackedWideUv:
+                return sizeof(PackedWideUvVertex);
+            case VertexFormat::PackedTangentWideUv:
+                return sizeof(PackedTangentWideUvVertex);
+        }
+        return sizeof(Vertex);
+    }
+
+    //sabijanje ako ukupno slobodnog mesta ima dovoljno, a nijedan opseg nije dovoljno veliki; inace prosirenje
+    void makeRoom(VertexFormat format, size_t vertex_count, size_t index_bytes) {
+        FormatBuffers& buffers = m_formats[(size_t) format];
+        bool fits = buffers.m_vertices.largestBlock() >= vertex_count && buffers.m_indices.largestBlock() >= index_bytes;
+        if (fits)
+            return;
+
+        if (buffers.m_vertex_buffer != 0 && buffers.m_vertices.freeSize() >= vertex_count &&
+            buffers.m_indices.freeSize() >= index_bytes) {
+            defragment(format);
+            return;
+        }
+
+        //novi prostor na kraju sam mora da primi zahtev, jer poslednji slobodan opseg ne mora biti na kraju
+        if (buffers.m_vertices.largestBlock() < vertex_count) {
+            size_t capacity = std::max(buffers.m_vertices.capacity() * 2, (size_t) INITIAL_VERTICES);
+            while (capacity - buffers.m_vertices.capacity() < vertex_count)
+                capacity *= 2;
+            buffers.m_vertex_buffer = growBuffer(buffers.m_vertex_buffer, buffers.m_vertices.capacity() * buffers.m_vertex_size,
+                                                 capacity * buffers.m_vertex_size);
+            buffers.m_vertices.grow(capacity);
+        }
+        if (buffers.m_indices.largestBlock() < index_bytes) {
+            size_t capacity = std::max(buffers.m_indices.capacity() * 2, (size_t) INITIAL_INDEX_BYTES);
+            while (capacity - buffers.m_indices.capacity() < index_bytes)
+                capacity *= 2;
+            buffers.m_index_buffer = growBuffer(buffers.m_index_buffer, buffers.m_indices.capacity(), capacity);
+            buffers.m_indices.grow(capacity);
+        }
+        setupVertexArray(format);
+        m_grows++;
+    }
+
+    static unsigned int createBuffer(size_t bytes) {
+        unsigned int buffer;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, bytes, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return buffer;
+    }
+
+    //novi bafer sa starim sadrzajem na pocetku
+    static unsigned int growBuffer(unsigned int buffer, size_t old_bytes, size_t new_bytes) {
+        unsigned int grown = createBuffer(new_bytes);
+        if (buffer != 0) {
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, old_bytes);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            glDeleteBuffers(1, &buffer);
+        }
+        return grown;
+    }
+
+    //VAO pamti bafere, pa se ponovo podesava posle svake zamene VBO-a ili EBO-a
+    void setupVertexArray(VertexFormat format) {
+        FormatBuffers& buffers = m_formats[(size_t) format];
+        glBindVertexArray(buffers.m_vertex_array);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers.m_vertex_buffer);
+        switch (format) {
+            case VertexFormat::Full:
+                setupAttributes<Vertex>();
+                break;
+            case VertexFormat::Packed:
+                setupAttributes<PackedVertex>();
+                break;
+            case VertexFormat::PackedTangent:
+                setupAttributes<PackedTangentVertex>();
+                break;
+            case VertexFormat::PackedWideUv:
+                setupAttributes<PackedWideUvVertex>();
+                break;
+            case VertexFormat::PackedTangentWideUv:
+                setupAttributes<PackedTangentWideUvVertex>();
+                break;
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.m_index_buffer);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    template <typename V>
+    static void setupAttributes() {
+        for (const VertexAttribute& attribute : VertexLayout<V>::attributes()) {
+            glEnableVertexAttribArray(attribute.m_location);
+            glVertexAttribPointer(attribute.m_location, attribute.m_components, attribute.m_type, attribute.m_normalized,
+                                  sizeof(V), (void*) attribute.m_offset);
+        }
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_GEOMETRYPOOL_H
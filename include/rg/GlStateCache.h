@@ -0,0 +1,109 @@
+#ifndef PROJECT_BASE_GLSTATECACHE_H
+#define PROJECT_BASE_GLSTATECACHE_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+namespace rg {
+
+//poslednje postavljeno GL stanje; vezivanje iste vrednosti se preskace
+//vazi samo dok niko drugi ne menja stanje direktno, pa se posle takvog koda poziva reset()
+class GlStateCache {
+public:
+    static const unsigned int TEXTURE_UNITS = 16;
+
+    //zaboravlja sve vrednosti, sledece vezivanje svakog stanja ide do GL-a
+    void reset() {
+        m_program = UNKNOWN;
+        m_vertex_array = UNKNOWN;
+        m_array_buffer = UNKNOWN;
+        m_active_unit = UNKNOWN;
+        for (unsigned int& texture : m_textures) {
+            texture = UNKNOWN;
+        }
+    }
+
+    //true ako je stanje stvarno promenjeno
+    bool useProgram(unsigned int program) {
+        if (m_program == program) {
+            m_skipped++;
+            return false;
+        }
+        glUseProgram(program);
+        m_program = program;
+        m_changes++;
+        return true;
+    }
+
+    bool bindVertexArray(unsigned int vertex_array) {
+        if (m_vertex_array == vertex_array) {
+            m_skipped++;
+            return false;
+        }
+        glBindVertexArray(vertex_array);
+        m_vertex_array = vertex_array;
+        m_changes++;
+        return true;
+    }
+
+    bool bindArrayBuffer(unsigned int buffer) {
+        if (m_array_buffer == buffer) {
+            m_skipped++;
+            return false;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        m_array_buffer = buffer;
+        m_changes++;
+        return true;
+    }
+
+    //GL_TEXTURE_2D na jedinici unit; jedinice preko TEXTURE_UNITS se ne kesiraju
+    bool bindTexture2D(unsigned int unit, unsigned int texture) {
+        if (unit < TEXTURE_UNITS && m_textures[unit] == texture) {
+            m_skipped++;
+            return false;
+        }
+        if (m_active_unit != unit) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            m_active_unit = unit;
+        }
+        glBindTexture(GL_TEXTURE_2D, texture);
+        if (unit < TEXTURE_UNITS) {
+            m_textures[unit] = texture;
+        }
+        m_changes++;
+        return true;
+    }
+
+    //broj stvarnih i preskocenih promena od poslednjeg resetCounters()
+    size_t changes() const {
+        return m_changes;
+    }
+
+    size_t skipped() const {
+        return m_skipped;
+    }
+
+    void resetCounters() {
+        m_changes = 0;
+        m_skipped = 0;
+    }
+
+private:
+    static const unsigned int UNKNOWN = ~0u;
+
+    unsigned int m_program = UNKNOWN;
+    unsigned int m_vertex_array = UNKNOWN;
+    unsigned int m_array_buffer = UNKNOWN;
+    unsigned int m_active_unit = UNKNOWN;
+    unsigned int m_textures[TEXTURE_UNITS] = {UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN,
+                                              UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN};
+
+    size_t m_changes = 0;
+    size_t m_skipped = 0;
+};
+
+}
+
+#endif //PROJECT_BASE_GLSTATECACHE_H
@@ -0,0 +1,45 @@
+#ifndef PROJECT_BASE_HASH_H
+#define PROJECT_BASE_HASH_H
+
+#include <rg/MappedFile.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rg {
+
+const uint64_t FNV1A64_OFFSET = 14695981039346656037ull;
+const uint64_t FNV1A64_PRIME = 1099511628211ull;
+
+//FNV-1a hes niza bajtova, seed omogucava ulancavanje vise blokova
+inline uint64_t hashFnv1a64(const void* data, size_t size, uint64_t hash = FNV1A64_OFFSET) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV1A64_PRIME;
+    }
+    return hash;
+}
+
+//FNV-1a hes niske do nule; constexpr, pa se za konstantne niske racuna pri kompajliranju
+constexpr uint64_t hashString(const char* text, uint64_t hash = FNV1A64_OFFSET) {
+    for (; *text != '\0'; text++) {
+        hash ^= (unsigned char) *text;
+        hash *= FNV1A64_PRIME;
+    }
+    return hash;
+}
+
+//hes sadrzaja fajla, 0 ako fajl ne moze da se procita
+inline uint64_t hashFile(const std::string& path) {
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        return 0;
+    }
+    return hashFnv1a64(file.data(), file.size());
+}
+
+}
+
+#endif //PROJECT_BASE_HASH_H
@@ -0,0 +1,62 @@
+#ifndef PROJECT_BASE_IMAGE_H
+#define PROJECT_BASE_IMAGE_H
+
+#include <stb_image.h>
+#include <rg/ThreadPool.h>
+
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rg {
+
+struct StbiDeleter {
+    void operator()(unsigned char* data) const {
+        stbi_image_free(data);
+    }
+};
+
+//dekodirana slika u glavnoj memoriji, spremna za slanje na GPU
+struct Image {
+    std::string m_path;
+    int m_width = 0;
+    int m_height = 0;
+    int m_components = 0;
+    std::unique_ptr<unsigned char, StbiDeleter> m_data;
+
+    bool isValid() const {
+        return m_data != nullptr;
+    }
+};
+
+//dekodiranje slike; stbi_load ne koristi OpenGL pa moze da se poziva sa bilo koje niti
+inline Image decodeImage(const std::string& path) {
+    Image image;
+    image.m_path = path;
+    image.m_data.reset(stbi_load(path.c_str(), &image.m_width, &image.m_height, &image.m_components, 0));
+    return image;
+}
+
+inline std::shared_future<Image> decodeImageAsync(const std::string& path) {
+    return ThreadPool::instance().submit([path] { return decodeImage(path); }).share();
+}
+
+//pokrece dekodiranje svih slika odjednom, ista putanja se dekodira samo jednom
+inline std::vector<std::shared_future<Image>> decodeImagesAsync(const std::vector<std::string>& paths) {
+    std::map<std::string, std::shared_future<Image>> unique;
+    std::vector<std::shared_future<Image>> images;
+    for (const std::string& path : paths) {
+        auto it = unique.find(path);
+        if (it == unique.end()) {
+            it = unique.emplace(path, decodeImageAsync(path)).first;
+        }
+        images.push_back(it->second);
+    }
+    return images;
+}
+
+}
+
+#endif //PROJECT_BASE_IMAGE_H
@@ -0,0 +1,56 @@
+#ifndef PROJECT_BASE_LOD_H
+#define PROJECT_BASE_LOD_H
+
+#include <glm/glm.hpp>
+
+#include <rg/Bounds.h>
+#include <rg/Mesh.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace rg {
+
+//izbor nivoa detalja po gresci projektovanoj na ekran
+struct LodSelector {
+    bool m_enabled = true;
+
+    //najveca dozvoljena greska uproscavanja na ekranu, u pikselima
+    float m_pixel_error = 1.0f;
+
+    glm::vec3 m_camera_position = glm::vec3(0.0f);
+
+    //broj piksela koje zauzima jedinicna duzina na udaljenosti 1 od kamere, 0 dok se ne pozove setView
+    float m_pixels_per_unit = 0.0f;
+
+    void setView(const glm::vec3& camera_position, float fov_y, float viewport_height) {
+        m_camera_position = camera_position;
+        m_pixels_per_unit = viewport_height / (2.0f * std::tan(fov_y * 0.5f));
+    }
+
+    //najgrublji nivo cija greska na ekranu ne prelazi m_pixel_error
+    //sphere je sfera oko mesh-a u svetu, scale je najvece skaliranje model matrice
+    unsigned int select(const std::vector<MeshLod>& lods, const Sphere& sphere, float scale) const {
+        if (!m_enabled || m_pixels_per_unit <= 0.0f || lods.size() < 2) {
+            return 0;
+        }
+
+        //kamera unutar sfere vidi najblizi deo mesh-a, pa se uzima mala pozitivna udaljenost
+        float distance = std::max(glm::length(sphere.m_center - m_camera_position) - sphere.m_radius, 0.1f);
+        float pixels_per_unit = m_pixels_per_unit * scale / distance;
+
+        unsigned int lod = 0;
+        for (unsigned int i = 1; i < lods.size(); i++) {
+            if (lods[i].m_error * pixels_per_unit > m_pixel_error) {
+                break;
+            }
+            lod = i;
+        }
+        return lod;
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_LOD_H
@@ -0,0 +1,72 @@
+#ifndef PROJECT_BASE_MAPPEDFILE_H
+#define PROJECT_BASE_MAPPEDFILE_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+namespace rg {
+
+//fajl mapiran u memoriju samo za citanje, mapiranje traje koliko i objekat
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* data = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                m_data = static_cast<const unsigned char*>(data);
+                m_size = (size_t) info.st_size;
+            }
+        }
+
+        //mapiranje ostaje validno i nakon zatvaranja deskriptora
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (m_data) {
+            munmap(const_cast<unsigned char*>(m_data), m_size);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const {
+        return m_data != nullptr;
+    }
+
+    const unsigned char* data() const {
+        return m_data;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+//ime privremenog fajla za upis kesa koje ne deli ni jedan drugi pisac, ni nit ovog procesa ni drugi proces;
+//isti kes mogu istovremeno pisati dve niti koje ucitavaju isti izvor
+inline std::string temporaryPath(const std::string& path) {
+    static std::atomic<unsigned int> counter(0);
+    return path + "." + std::to_string((long) getpid()) + "." + std::to_string(counter++) + ".tmp";
+}
+
+}
+
+#endif //PROJECT_BASE_MAPPEDFILE_H
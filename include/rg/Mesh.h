@@ -7,55 +7,213 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <rg/Shader.h>
+#include <rg/Bounds.h>
+#include <rg/VertexLayout.h>
+#include <rg/FrameStats.h>
+#include <rg/GeometryPool.h>
+#include <rg/GlStateCache.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
-struct Vertex {
-    glm::vec3 m_position;
-    glm::vec3 m_normal;
-    glm::vec2 m_texture_coordinates;
-    glm::vec3 m_tangent;
-    glm::vec3 m_bitangent;
-};
-
-
-
 struct Texture {
     unsigned int m_id;
     std::string m_type;
     std::string m_path;
 };
 
+//nivo detalja: opseg u zajednickom nizu indeksa i greska uproscavanja u jedinicama duzine modela
+struct MeshLod {
+    unsigned int m_index_offset;
+    unsigned int m_index_count;
+    float m_error;
+};
+
+//podaci mesh-a pre slanja na GPU (rezultat ASSIMP-a ili binarnog kesa)
+//m_indices sadrzi indekse svih nivoa detalja jedan za drugim, prazan m_lods znaci samo originalni nivo
+struct MeshData {
+    std::vector<Vertex>       m_vertices;
+    std::vector<unsigned int> m_indices;
+    std::vector<Texture>      m_textures;
+    std::vector<MeshLod>      m_lods;
+    rg::AABB                  m_bounds;
+    rg::Sphere                m_sphere;
+};
+
 class Mesh {
 public:
     //atributi mesh-a
     std::vector<Vertex>       m_vertices;
     std::vector<unsigned int> m_indices;
     std::vector<Texture>      m_textures;
+    std::vector<MeshLod>      m_lods;
+    rg::AABB                  m_bounds;
+    rg::Sphere                m_sphere;
 
+    //VAO je zajednicki za sve mesh-eve istog formata, geometrija je opseg u baferima GeometryPool-a
     unsigned int VAO;
     std::string m_glslIdentifierPrefix;
+
+    //materijal (skup tekstura i prefiks imena) za kljuc RenderQueue-a, 0 dok ga red ne dodeli
+    unsigned int m_material_id = 0;
+
+    //osobine varijante shader-a koje materijal zahteva (rg::SHADER_ALPHA_TEST, rg::SHADER_NORMAL_MAP)
+    uint32_t m_shader_features = 0;
+
+    //format verteksa na GPU-u i koliko bajtova zauzimaju
+    rg::VertexFormat m_vertex_format;
+    size_t m_vertex_bytes = 0;
+
+    //sirina indeksa se bira po mesh-u: GL_UNSIGNED_SHORT kad god broj verteksa to dozvoljava
+    GLenum m_index_type = GL_UNSIGNED_INT;
+    size_t m_index_bytes = 0;
+
     // constructor
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
+    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures,
+         rg::VertexFormat vertex_format = rg::VertexFormat::Packed, std::vector<MeshLod> lods = {})
     {
-        this->m_vertices = vertices;
-        this->m_indices = indices;
-        this->m_textures = textures;
+        this->m_vertices = std::move(vertices);
+        this->m_indices = std::move(indices);
+        this->m_textures = std::move(textures);
+        this->m_lods = std::move(lods);
+        //Packed formati prelaze na float32 UV kad su UV koordinate van opsega u kome je half float dovoljno tacan
+        this->m_vertex_format = rg::resolveVertexFormat(vertex_format, m_vertices);
+        if (m_lods.empty()) {
+            m_lods.push_back({0, (unsigned int) m_indices.size(), 0.0f});
+        }
 
         setupMesh();
     }
 
-    //renderovanje mesh-a
-    void Draw(Shader &shader)
+    //renderovanje mesh-a na zadatom nivou detalja
+    void Draw(Shader &shader, unsigned int lod = 0)
+    {
+        bindTextures(shader, nullptr);
+
+        //crtanje mesh-a
+        //nivo detalja je opseg u zajednickom EBO-u
+        glBindVertexArray(VAO);
+        DrawBound(lod);
+        glBindVertexArray(0);
+
+        //vracanje na podrazumevane vrednosti
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    //crtanje count instanci jednim pozivom; model matrice se citaju iz instance_buffer od bajta offset
+    //i ulaze u shader na lokacijama INSTANCE_MATRIX_LOCATION..+3
+    void DrawInstanced(Shader &shader, unsigned int instance_buffer, size_t offset, unsigned int count, unsigned int lod = 0)
+    {
+        if (count == 0)
+            return;
+
+        bindTextures(shader, nullptr);
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+        drawInstances(offset, count, lod);
+        glBindVertexArray(0);
+
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    //delovi Draw-a za RenderQueue: teksture i bafere vezuje kroz kes stanja, shader mora biti aktivan
+    void BindMaterial(Shader &shader, rg::GlStateCache &state)
+    {
+        bindTextures(shader, &state);
+    }
+
+    //crtanje kada je VAO ovog mesh-a vec vezan
+    void DrawBound(unsigned int lod = 0)
+    {
+        const MeshLod& range = LodRange(lod);
+        glDrawElementsBaseVertex(GL_TRIANGLES, range.m_index_count, m_index_type, indexOffset(range), BaseVertex());
+        rg::FrameStats::instance().recordDraw(range.m_index_count / 3, (unsigned int) (&range - &m_lods[0]));
+    }
+
+    void DrawBoundInstanced(rg::GlStateCache &state, unsigned int instance_buffer, size_t offset, unsigned int count,
+                            unsigned int lod = 0)
+    {
+        if (count == 0)
+            return;
+        state.bindArrayBuffer(instance_buffer);
+        drawInstances(offset, count, lod);
+    }
+
+    //prefiks imena sampler-a u shader-u (npr. "material."); imena se ponovo grade pri sledecem crtanju
+    void SetTextureNamePrefix(const std::string &prefix)
+    {
+        m_glslIdentifierPrefix = prefix;
+        m_sampler_names.clear();
+        m_material_id = 0;
+    }
+
+    //opseg indeksa nivoa detalja; nivo veci od poslednjeg daje poslednji
+    const MeshLod& LodRange(unsigned int lod) const
+    {
+        return m_lods[std::min<size_t>(lod, m_lods.size() - 1)];
+    }
+
+    //pocetak verteksa mesh-a u zajednickom baferu; dodaje se svakom indeksu pri crtanju
+    GLint BaseVertex() const
+    {
+        return (GLint) rg::GeometryPool::instance().allocation(m_geometry).m_vertex_offset;
+    }
+
+    //prvi indeks nivoa detalja u zajednickom baferu indeksa, u jedinicama m_index_type
+    unsigned int FirstIndex(const MeshLod& range) const
+    {
+        return (unsigned int) (rg::GeometryPool::instance().allocation(m_geometry).m_index_offset / indexSize()) +
+               range.m_index_offset;
+    }
+
+    //vracanje opsega geometrije u GeometryPool, teksture pripadaju modelu
+    //kopije mesh-a dele isti opseg, pa se Release poziva samo za jednu
+    void Release()
+    {
+        rg::GeometryPool::instance().free(m_geometry);
+        m_geometry = rg::GeometryPool::INVALID_HANDLE;
+        VAO = 0;
+    }
+
+private:
+    //opseg geometrije u GeometryPool-u
+    rg::GeometryPool::Handle m_geometry = rg::GeometryPool::INVALID_HANDLE;
+
+    //hesirana imena sampler-a za svaku teksturu, grade se jednom da crtanje ne bi spajalo niske
+    std::vector<rg::UniformName> m_sampler_names;
+
+    //bez kesa stanja svaka tekstura se vezuje direktno
+    void bindTextures(Shader &shader, rg::GlStateCache *state)
+    {
+        if (m_sampler_names.size() != m_textures.size())
+            buildSamplerNames();
+
+        for(unsigned int i = 0; i < m_textures.size(); i++)
+        {
+            shader.setInt(m_sampler_names[i], i);
+            if (state) {
+                state->bindTexture2D(i, m_textures[i].m_id);
+            } else {
+                glActiveTexture(GL_TEXTURE0 + i);
+                glBindTexture(GL_TEXTURE_2D, m_textures[i].m_id);
+            }
+        }
+    }
+
+    void buildSamplerNames()
     {
         unsigned int diffuseNr  = 1;
         unsigned int specularNr = 1;
         unsigned int normalNr   = 1;
         unsigned int heightNr   = 1;
+        m_sampler_names.clear();
         for(unsigned int i = 0; i < m_textures.size(); i++)
         {
-            glActiveTexture(GL_TEXTURE0 + i);
             std::string number;
             std::string name = m_textures[i].m_type;
             if(name == "texture_diffuse")
@@ -67,55 +225,81 @@ public:
             else if(name == "texture_height")
                 number = std::to_string(heightNr++); // transfer unsigned int to stream
 
-            glUniform1i(glGetUniformLocation(shader.m_id, (m_glslIdentifierPrefix + name + number).c_str()), i);
-            glBindTexture(GL_TEXTURE_2D, m_textures[i].m_id);
+            m_sampler_names.push_back(rg::UniformName(m_glslIdentifierPrefix + name + number));
         }
+    }
 
+    //VAO mesh-a i bafer instanci moraju biti vezani
+    void drawInstances(size_t offset, unsigned int count, unsigned int lod)
+    {
+        const MeshLod& range = LodRange(lod);
+        for (unsigned int column = 0; column < 4; column++) {
+            unsigned int location = rg::INSTANCE_MATRIX_LOCATION + column;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  (void*) (offset + column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(location, 1);
+        }
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.m_index_count, m_index_type, indexOffset(range), count,
+                                          BaseVertex());
+        rg::FrameStats::instance().recordDraw((size_t) range.m_index_count / 3 * count, (unsigned int) (&range - &m_lods[0]));
+    }
 
-
-        //crtanje mesh-a
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        //vracanje na podrazumevane vrednosti
-        glActiveTexture(GL_TEXTURE0);
+    size_t indexSize() const
+    {
+        return m_index_type == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
     }
 
-private:
-    //podaci za renderovanje
-    unsigned int VBO, EBO;
+    void* indexOffset(const MeshLod& range) const
+    {
+        return (void*) ((size_t) FirstIndex(range) * indexSize());
+    }
 
-    //inicijalizacija svih buffer objekata/nizova
+    //slanje geometrije u zajednicke bafere formata; VAO formata vec ima sve atribute verteksa
     void setupMesh()
     {
-        //kreiranje buffer objekata/nizova
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
+        switch (m_vertex_format) {
+            case rg::VertexFormat::Full:
+                setupVertices<Vertex>();
+                break;
+            case rg::VertexFormat::Packed:
+                setupVertices<rg::PackedVertex>();
+                break;
+            case rg::VertexFormat::PackedTangent:
+                setupVertices<rg::PackedTangentVertex>();
+                break;
+            case rg::VertexFormat::PackedWideUv:
+                setupVertices<rg::PackedWideUvVertex>();
+                break;
+            case rg::VertexFormat::PackedTangentWideUv:
+                setupVertices<rg::PackedTangentWideUvVertex>();
+                break;
+        }
+        VAO = rg::GeometryPool::instance().vertexArray(m_vertex_format);
+    }
 
-        glBindVertexArray(VAO);
-        //ucitavanje podataka u buffer objekat
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-        glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(Vertex), &m_vertices[0], GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int), &m_indices[0], GL_STATIC_DRAW);
-
-        //postavljanje pokazivaca verteksa za atribute
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_normal));
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_texture_coordinates));
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_tangent));
-        glEnableVertexAttribArray(4);
-        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_bitangent));
+    //konverzija verteksa iz VertexLayout<V>, pa setupMesh ne zavisi od formata
+    template <typename V>
+    void setupVertices()
+    {
+        std::vector<V> converted;
+        converted.reserve(m_vertices.size());
+        for (const Vertex& vertex : m_vertices) {
+            converted.push_back(rg::VertexLayout<V>::convert(vertex));
+        }
+        m_vertex_bytes = converted.size() * sizeof(V);
 
-        glBindVertexArray(0);
+        rg::GeometryPool& pool = rg::GeometryPool::instance();
+        if (m_vertices.size() <= (size_t) std::numeric_limits<uint16_t>::max() + 1) {
+            std::vector<uint16_t> short_indices(m_indices.begin(), m_indices.end());
+            m_index_type = GL_UNSIGNED_SHORT;
+            m_index_bytes = short_indices.size() * sizeof(uint16_t);
+            m_geometry = pool.allocate(m_vertex_format, converted.data(), converted.size(), short_indices.data(), m_index_bytes);
+        } else {
+            m_index_type = GL_UNSIGNED_INT;
+            m_index_bytes = m_indices.size() * sizeof(unsigned int);
+            m_geometry = pool.allocate(m_vertex_format, converted.data(), converted.size(), m_indices.data(), m_index_bytes);
+        }
     }
 };
 #endif
\ No newline at end of file
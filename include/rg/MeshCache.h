@@ -0,0 +1,213 @@
+#ifndef PROJECT_BASE_MESHCACHE_H
+#define PROJECT_BASE_MESHCACHE_H
+
+#include <rg/Mesh.h>
+#include <rg/MappedFile.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace rg {
+
+//binarni kes mesh-eva modela, zaobilazi ASSIMP pri svakom sledecem pokretanju
+//format (native endianness, sve poravnato na 4 bajta):
+//  MeshCacheHeader
+//  za svaki mesh: MeshCacheMeshHeader, verteksi, indeksi svih nivoa detalja, MeshLod nizovi, reference na teksture
+//  referenca na teksturu: duzina tipa, duzina putanje, tip, putanja (dopunjeno do 4 bajta)
+//verziju treba povecati pri svakoj promeni formata, strukture Vertex ili obrade posle importa
+const uint32_t MESH_CACHE_MAGIC = 0x434d4752; // "RGMC"
+const uint32_t MESH_CACHE_VERSION = 6;
+
+struct MeshCacheHeader {
+    uint32_t m_magic;
+    uint32_t m_version;
+    uint32_t m_vertex_size;
+    uint32_t m_import_flags;
+    uint64_t m_source_hash;
+    uint32_t m_mesh_count;
+    float m_import_ms;
+};
+
+struct MeshCacheMeshHeader {
+    uint32_t m_vertex_count;
+    uint32_t m_index_count;
+    uint32_t m_texture_count;
+    uint32_t m_lod_count;
+    float m_bounds_min[3];
+    float m_bounds_max[3];
+    float m_sphere[4];
+};
+
+class MeshCache {
+public:
+    //ucitava mesh-eve iz kesa, vraca false ako kes ne postoji ili je zastareo
+    static bool read(const std::string& cache_path, uint64_t source_hash, uint32_t import_flags,
+                     std::vector<MeshData>& meshes, float& import_ms) {
+
+        MappedFile file(cache_path);
+        if (!file.isOpen()) {
+            return false;
+        }
+
+        Reader reader{file.data(), file.data() + file.size()};
+
+        MeshCacheHeader header;
+        if (!reader.read(&header, sizeof(header))) {
+            return false;
+        }
+
+        //invalidacija: drugi format, druga verzija izvornog fajla ili drugi ASSIMP flegovi
+        if (header.m_magic != MESH_CACHE_MAGIC || header.m_version != MESH_CACHE_VERSION ||
+            header.m_vertex_size != sizeof(Vertex) || header.m_source_hash != source_hash ||
+            header.m_import_flags != import_flags) {
+            return false;
+        }
+
+        std::vector<MeshData> result(header.m_mesh_count);
+        for (MeshData& mesh : result) {
+            MeshCacheMeshHeader mesh_header;
+            if (!reader.read(&mesh_header, sizeof(mesh_header))) {
+                return corrupted(cache_path);
+            }
+
+            mesh.m_vertices.resize(mesh_header.m_vertex_count);
+            mesh.m_indices.resize(mesh_header.m_index_count);
+            mesh.m_lods.resize(mesh_header.m_lod_count);
+            if (!reader.read(mesh.m_vertices.data(), mesh.m_vertices.size() * sizeof(Vertex)) ||
+                !reader.read(mesh.m_indices.data(), mesh.m_indices.size() * sizeof(unsigned int)) ||
+                !reader.read(mesh.m_lods.data(), mesh.m_lods.size() * sizeof(MeshLod))) {
+                return corrupted(cache_path);
+            }
+            for (const MeshLod& lod : mesh.m_lods) {
+                if ((size_t) lod.m_index_offset + lod.m_index_count > mesh.m_indices.size()) {
+                    return corrupted(cache_path);
+                }
+            }
+
+            mesh.m_bounds.m_min = glm::vec3(mesh_header.m_bounds_min[0], mesh_header.m_bounds_min[1], mesh_header.m_bounds_min[2]);
+            mesh.m_bounds.m_max = glm::vec3(mesh_header.m_bounds_max[0], mesh_header.m_bounds_max[1], mesh_header.m_bounds_max[2]);
+            mesh.m_sphere.m_center = glm::vec3(mesh_header.m_sphere[0], mesh_header.m_sphere[1], mesh_header.m_sphere[2]);
+            mesh.m_sphere.m_radius = mesh_header.m_sphere[3];
+
+            mesh.m_textures.resize(mesh_header.m_texture_count);
+            for (Texture& texture : mesh.m_textures) {
+                if (!reader.readString(texture.m_type) || !reader.readString(texture.m_path)) {
+                    return corrupted(cache_path);
+                }
+                texture.m_id = 0;
+            }
+        }
+
+        meshes.swap(result);
+        import_ms = header.m_import_ms;
+        return true;
+    }
+
+    //upisuje kes u svoj privremeni fajl pa ga preimenuje, da prekinut ili istovremen upis istog modela iz druge
+    //niti ne bi ostavio pokvaren kes
+    static bool write(const std::string& cache_path, uint64_t source_hash, uint32_t import_flags,
+                      const std::vector<MeshData>& meshes, float import_ms) {
+
+        std::string temporary_path = temporaryPath(cache_path);
+        std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "ERROR::MESH_CACHE::NEUSPESNO_PISANJE " << cache_path << "\n";
+            return false;
+        }
+
+        MeshCacheHeader header;
+        header.m_magic = MESH_CACHE_MAGIC;
+        header.m_version = MESH_CACHE_VERSION;
+        header.m_vertex_size = sizeof(Vertex);
+        header.m_import_flags = import_flags;
+        header.m_source_hash = source_hash;
+        header.m_mesh_count = (uint32_t) meshes.size();
+        header.m_import_ms = import_ms;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        for (const MeshData& mesh : meshes) {
+            MeshCacheMeshHeader mesh_header;
+            mesh_header.m_vertex_count = (uint32_t) mesh.m_vertices.size();
+            mesh_header.m_index_count = (uint32_t) mesh.m_indices.size();
+            mesh_header.m_texture_count = (uint32_t) mesh.m_textures.size();
+            mesh_header.m_lod_count = (uint32_t) mesh.m_lods.size();
+            for (int i = 0; i < 3; i++) {
+                mesh_header.m_bounds_min[i] = mesh.m_bounds.m_min[i];
+                mesh_header.m_bounds_max[i] = mesh.m_bounds.m_max[i];
+                mesh_header.m_sphere[i] = mesh.m_sphere.m_center[i];
+            }
+            mesh_header.m_sphere[3] = mesh.m_sphere.m_radius;
+            out.write(reinterpret_cast<const char*>(&mesh_header), sizeof(mesh_header));
+            out.write(reinterpret_cast<const char*>(mesh.m_vertices.data()), mesh.m_vertices.size() * sizeof(Vertex));
+            out.write(reinterpret_cast<const char*>(mesh.m_indices.data()), mesh.m_indices.size() * sizeof(unsigned int));
+            out.write(reinterpret_cast<const char*>(mesh.m_lods.data()), mesh.m_lods.size() * sizeof(MeshLod));
+
+            for (const Texture& texture : mesh.m_textures) {
+                writeString(out, texture.m_type);
+                writeString(out, texture.m_path);
+            }
+        }
+
+        out.close();
+        if (!out || std::rename(temporary_path.c_str(), cache_path.c_str()) != 0) {
+            std::cerr << "ERROR::MESH_CACHE::NEUSPESNO_PISANJE " << cache_path << "\n";
+            std::remove(temporary_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    //citanje iz mapiranog fajla sa proverom granica
+    struct Reader {
+        const unsigned char* m_current;
+        const unsigned char* m_end;
+
+        bool read(void* destination, size_t size) {
+            if ((size_t) (m_end - m_current) < size) {
+                return false;
+            }
+            if (size > 0) {
+                std::memcpy(destination, m_current, size);
+            }
+            m_current += size;
+            return true;
+        }
+
+        bool readString(std::string& value) {
+            uint32_t length;
+            if (!read(&length, sizeof(length)) || (size_t) (m_end - m_current) < padded(length)) {
+                return false;
+            }
+            value.assign(reinterpret_cast<const char*>(m_current), length);
+            m_current += padded(length);
+            return true;
+        }
+    };
+
+    static size_t padded(size_t length) {
+        return (length + 3) & ~(size_t) 3;
+    }
+
+    static void writeString(std::ofstream& out, const std::string& value) {
+        uint32_t length = (uint32_t) value.size();
+        const char padding[4] = {0, 0, 0, 0};
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(value.data(), length);
+        out.write(padding, padded(length) - length);
+    }
+
+    static bool corrupted(const std::string& cache_path) {
+        std::cerr << "ERROR::MESH_CACHE::OSTECEN_KES " << cache_path << "\n";
+        return false;
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_MESHCACHE_H
@@ -0,0 +1,374 @@
+#ifndef PROJECT_BASE_MESHOPTIMIZER_H
+#define PROJECT_BASE_MESHOPTIMIZER_H
+
+#include <glm/glm.hpp>
+
+#include <rg/Mesh.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace rg {
+
+//velicina FIFO kesa transformisanih verteksa za koju se optimizuje i meri
+const unsigned int VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats {
+    float m_acmr = 0.0f; // prosecan broj transformacija po trouglu
+    float m_atvr = 0.0f; // prosecan broj transformacija po verteksu (1 je optimum)
+};
+
+//simulacija FIFO kesa verteksa nad datim redosledom indeksa
+inline VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertex_count,
+                                           unsigned int cache_size = VERTEX_CACHE_SIZE) {
+    VertexCacheStats stats;
+    if (indices.empty()) {
+        return stats;
+    }
+
+    //verteks je u kesu ako je dodat u poslednjih cache_size promasaja
+    std::vector<unsigned int> inserted_at(vertex_count, 0);
+    std::vector<bool> referenced(vertex_count, false);
+    unsigned int misses = 0;
+    size_t unique = 0;
+    for (unsigned int index : indices) {
+        if (!referenced[index]) {
+            referenced[index] = true;
+            unique++;
+        }
+        if (inserted_at[index] == 0 || misses - inserted_at[index] + 1 > cache_size) {
+            misses++;
+            inserted_at[index] = misses;
+        }
+    }
+
+    stats.m_acmr = (float) misses / (float) (indices.size() / 3);
+    stats.m_atvr = (float) misses / (float) unique;
+    return stats;
+}
+
+//Tipsify (Sander, Nehab, Barczak 2007): redosled trouglova za kes verteksa
+//boundaries dobija pocetke grupa trouglova izmedju skokova na novi deo mesh-a (u trouglovima)
+inline std::vector<unsigned int> optimizeVertexCache(const std::vector<unsigned int>& indices, size_t vertex_count,
+                                                     std::vector<size_t>& boundaries,
+                                                     unsigned int cache_size = VERTEX_CACHE_SIZE) {
+    size_t triangle_count = indices.size() / 3;
+
+    //trouglovi susedni svakom verteksu
+    std::vector<unsigned int> offsets(vertex_count + 1, 0);
+    for (unsigned int index : indices) {
+        offsets[index + 1]++;
+    }
+    for (size_t v = 0; v < vertex_count; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangle_count; t++) {
+        for (int k = 0; k < 3; k++) {
+            adjacency[fill[indices[t * 3 + k]]++] = (unsigned int) t;
+        }
+    }
+
+    std::vector<unsigned int> live(vertex_count);
+    for (size_t v = 0; v < vertex_count; v++) {
+        live[v] = offsets[v + 1] - offsets[v];
+    }
+
+    std::vector<unsigned int> timestamps(vertex_count, 0);
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<unsigned int> dead_end;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    boundaries.clear();
+
+    unsigned int time = cache_size + 1;
+    size_t cursor = 0;
+
+    //kada u okolini nema trouglova, nastavlja se od poslednjih verteksa sa steka ili od prvog neobradjenog
+    auto skipDeadEnd = [&]() -> long {
+        while (!dead_end.empty()) {
+            unsigned int v = dead_end.back();
+            dead_end.pop_back();
+            if (live[v] > 0) {
+                return v;
+            }
+        }
+        while (cursor < vertex_count) {
+            if (live[cursor] > 0) {
+                return (long) cursor;
+            }
+            cursor++;
+        }
+        return -1;
+    };
+
+    long fanning = skipDeadEnd();
+    while (fanning >= 0) {
+        candidates.clear();
+        for (unsigned int i = offsets[fanning]; i < offsets[fanning + 1]; i++) {
+            unsigned int t = adjacency[i];
+            if (emitted[t]) {
+                continue;
+            }
+            for (int k = 0; k < 3; k++) {
+                unsigned int v = indices[t * 3 + k];
+                result.push_back(v);
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - timestamps[v] > cache_size) {
+                    timestamps[v] = time++;
+                }
+            }
+            emitted[t] = true;
+        }
+
+        //sledeci verteks: onaj koji ce jos biti u kesu kada se obrade svi njegovi trouglovi, sto stariji
+        long next = -1;
+        long best_priority = -1;
+        for (unsigned int v : candidates) {
+            if (live[v] == 0) {
+                continue;
+            }
+            long priority = 0;
+            if (time - timestamps[v] + 2 * live[v] <= cache_size) {
+                priority = time - timestamps[v];
+            }
+            if (priority > best_priority) {
+                best_priority = priority;
+                next = v;
+            }
+        }
+
+        if (next < 0) {
+            next = skipDeadEnd();
+            boundaries.push_back(result.size() / 3);
+        }
+        fanning = next;
+    }
+
+    //pocetak prve grupe je uvek 0, poslednji skok ne zapocinje novu grupu
+    if (!boundaries.empty()) {
+        boundaries.pop_back();
+    }
+    boundaries.insert(boundaries.begin(), 0);
+    return result;
+}
+
+//od mogucih granica grupa zadrzava samo one na kojima grupa, pocevsi sa praznim kesom, nema ACMR
+//veci od threshold * ACMR celog mesh-a; tako premestanje grupa ne kvari mnogo efikasnost kesa
+inline std::vector<size_t> overdrawClusters(const std::vector<unsigned int>& indices, size_t vertex_count,
+                                            const std::vector<size_t>& boundaries, float threshold,
+                                            unsigned int cache_size = VERTEX_CACHE_SIZE) {
+    size_t triangle_count = indices.size() / 3;
+    float mesh_acmr = analyzeVertexCache(indices, vertex_count, cache_size).m_acmr;
+
+    std::vector<size_t> clusters;
+    std::vector<unsigned int> inserted_at(vertex_count, 0);
+    unsigned int misses = 0;
+    unsigned int cluster_start_misses = 0;
+    size_t cluster_start = 0;
+    size_t next_boundary = 1;
+
+    clusters.push_back(0);
+    for (size_t t = 0; t < triangle_count; t++) {
+        for (int k = 0; k < 3; k++) {
+            unsigned int index = indices[t * 3 + k];
+            //verteksi dodati pre pocetka grupe se ne racunaju, grupa pocinje sa praznim kesom
+            if (inserted_at[index] <= cluster_start_misses || misses - inserted_at[index] + 1 > cache_size) {
+                misses++;
+                inserted_at[index] = misses;
+            }
+        }
+
+        while (next_boundary < boundaries.size() && boundaries[next_boundary] <= t) {
+            next_boundary++;
+        }
+        if (next_boundary < boundaries.size() && boundaries[next_boundary] == t + 1) {
+            float cluster_acmr = (float) (misses - cluster_start_misses) / (float) (t + 1 - cluster_start);
+            if (cluster_acmr <= threshold * mesh_acmr) {
+                clusters.push_back(t + 1);
+                cluster_start = t + 1;
+                cluster_start_misses = misses;
+            }
+        }
+    }
+    return clusters;
+}
+
+//redjanje grupa trouglova tako da se prvo crtaju one okrenute ka spolja, koje najcesce zaklanjaju ostale
+//unutar grupe redosled (pa i efikasnost kesa) ostaje isti
+inline std::vector<unsigned int> optimizeOverdraw(const std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+                                                  const std::vector<size_t>& boundaries, float threshold = 1.05f) {
+    std::vector<size_t> clusters = overdrawClusters(indices, vertices.size(), boundaries, threshold);
+    size_t triangle_count = indices.size() / 3;
+
+    glm::vec3 mesh_center(0.0f);
+    float mesh_area = 0.0f;
+
+    struct Cluster {
+        size_t m_begin;
+        size_t m_end;
+        glm::vec3 m_centroid;
+        glm::vec3 m_normal;
+        float m_sort_key;
+    };
+    std::vector<Cluster> sorted;
+
+    for (size_t i = 0; i < clusters.size(); i++) {
+        Cluster cluster;
+        cluster.m_begin = clusters[i];
+        cluster.m_end = i + 1 < clusters.size() ? clusters[i + 1] : triangle_count;
+        cluster.m_centroid = glm::vec3(0.0f);
+        cluster.m_normal = glm::vec3(0.0f);
+
+        float area = 0.0f;
+        for (size_t t = cluster.m_begin; t < cluster.m_end; t++) {
+            const glm::vec3& a = vertices[indices[t * 3 + 0]].m_position;
+            const glm::vec3& b = vertices[indices[t * 3 + 1]].m_position;
+            const glm::vec3& c = vertices[indices[t * 3 + 2]].m_position;
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            float triangle_area = glm::length(normal) * 0.5f;
+            cluster.m_normal += normal;
+            cluster.m_centroid += (a + b + c) * (triangle_area / 3.0f);
+            area += triangle_area;
+        }
+
+        mesh_center += cluster.m_centroid;
+        mesh_area += area;
+        if (area > 0.0f) {
+            cluster.m_centroid /= area;
+        }
+        sorted.push_back(cluster);
+    }
+
+    if (mesh_area > 0.0f) {
+        mesh_center /= mesh_area;
+    }
+
+    for (Cluster& cluster : sorted) {
+        float length = glm::length(cluster.m_normal);
+        cluster.m_sort_key = length > 0.0f ? glm::dot(cluster.m_centroid - mesh_center, cluster.m_normal / length) : 0.0f;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) {
+        return a.m_sort_key > b.m_sort_key;
+    });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (const Cluster& cluster : sorted) {
+        result.insert(result.end(), indices.begin() + cluster.m_begin * 3, indices.begin() + cluster.m_end * 3);
+    }
+    return result;
+}
+
+//verteksi se preuredjuju redom prvog koriscenja u indeksima, nekorisceni se izbacuju
+//vraca novu poziciju svakog starog verteksa (~0u za izbacene)
+inline std::vector<unsigned int> optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    std::vector<unsigned int> remap(vertices.size(), ~0u);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (unsigned int& index : indices) {
+        if (remap[index] == ~0u) {
+            remap[index] = (unsigned int) reordered.size();
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(reordered);
+    return remap;
+}
+
+struct MeshOptimizationStats {
+    VertexCacheStats m_before;
+    VertexCacheStats m_after;
+};
+
+//sve faze optimizacije redom: kes verteksa, overdraw, pa lokalnost citanja verteksa
+inline MeshOptimizationStats optimizeMesh(MeshData& mesh) {
+    MeshOptimizationStats stats;
+    stats.m_before = analyzeVertexCache(mesh.m_indices, mesh.m_vertices.size());
+
+    std::vector<size_t> boundaries;
+    mesh.m_indices = optimizeVertexCache(mesh.m_indices, mesh.m_vertices.size(), boundaries);
+    mesh.m_indices = optimizeOverdraw(mesh.m_indices, mesh.m_vertices, boundaries);
+    optimizeVertexFetch(mesh.m_vertices, mesh.m_indices);
+
+    stats.m_after = analyzeVertexCache(mesh.m_indices, mesh.m_vertices.size());
+    return stats;
+}
+
+//broj verteksa koji se moze adresirati 16-bitnim indeksima
+const size_t INDEX16_VERTEX_LIMIT = (size_t) std::numeric_limits<uint16_t>::max() + 1;
+
+//mesh koji tek malo prelazi granicu deli se na najvise ovoliko delova; veci ostaju sa 32-bitnim indeksima
+const size_t INDEX16_MAX_PARTS = 4;
+
+//deli mesh na delove od kojih svaki ima najvise vertex_limit verteksa
+//trouglovi se uzimaju redom, pa delovi zadrzavaju redosled za kes i lokalnost verteksa iz optimizeMesh
+//vraca false i ne menja parts ako deljenje nije potrebno ili bi dalo vise od max_parts delova
+inline bool splitForIndex16(const MeshData& mesh, std::vector<MeshData>& parts,
+                            size_t vertex_limit = INDEX16_VERTEX_LIMIT, size_t max_parts = INDEX16_MAX_PARTS) {
+    if (mesh.m_vertices.size() <= vertex_limit || mesh.m_vertices.size() > vertex_limit * max_parts) {
+        return false;
+    }
+
+    //lokalni indeks verteksa vazi samo ako je part_of jednak trenutnom delu
+    std::vector<size_t> part_of(mesh.m_vertices.size(), SIZE_MAX);
+    std::vector<unsigned int> local(mesh.m_vertices.size(), 0);
+    std::vector<MeshData> result;
+
+    for (size_t i = 0; i + 2 < mesh.m_indices.size(); i += 3) {
+        if (result.empty()) {
+            result.emplace_back();
+        }
+
+        //trougao ide u sledeci deo ako bi trenutni presao granicu
+        size_t missing = 0;
+        for (size_t k = 0; k < 3; k++) {
+            unsigned int index = mesh.m_indices[i + k];
+            bool repeated = (k > 0 && mesh.m_indices[i] == index) || (k > 1 && mesh.m_indices[i + 1] == index);
+            if (part_of[index] != result.size() - 1 && !repeated) {
+                missing++;
+            }
+        }
+        if (result.back().m_vertices.size() + missing > vertex_limit) {
+            if (result.size() == max_parts) {
+                return false;
+            }
+            result.emplace_back();
+        }
+
+        MeshData& part = result.back();
+        for (size_t k = 0; k < 3; k++) {
+            unsigned int index = mesh.m_indices[i + k];
+            if (part_of[index] != result.size() - 1) {
+                part_of[index] = result.size() - 1;
+                local[index] = (unsigned int) part.m_vertices.size();
+                part.m_vertices.push_back(mesh.m_vertices[index]);
+                part.m_bounds.extend(mesh.m_vertices[index].m_position);
+            }
+            part.m_indices.push_back(local[index]);
+        }
+    }
+
+    for (MeshData& part : result) {
+        part.m_textures = mesh.m_textures;
+        part.m_sphere.m_center = part.m_bounds.center();
+        for (const Vertex& vertex : part.m_vertices) {
+            part.m_sphere.include(vertex.m_position);
+        }
+    }
+    parts.swap(result);
+    return true;
+}
+
+}
+
+#endif //PROJECT_BASE_MESHOPTIMIZER_H
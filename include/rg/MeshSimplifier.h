@@ -0,0 +1,374 @@
+#ifndef PROJECT_BASE_MESHSIMPLIFIER_H
+#define PROJECT_BASE_MESHSIMPLIFIER_H
+
+#include <glm/glm.hpp>
+
+#include <rg/Mesh.h>
+#include <rg/MeshOptimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace rg {
+
+//najveci broj nivoa detalja po mesh-u, racunajuci i originalni
+const unsigned int MAX_LOD_COUNT = 5;
+
+//nivo se odbacuje ako ne smanji broj trouglova prethodnog nivoa bar na ovaj udeo
+const float LOD_MIN_REDUCTION = 0.8f;
+
+//tezina razlike normala u ceni kolapsa: kvadrat duzine ivice puta (1 - cos ugla normala), pa je clan u istim
+//jedinicama (kvadrat duzine) kao kvadratna greska; utice na redosled i prag kolapsa, ali ne ulazi u MeshLod::m_error
+const float LOD_NORMAL_WEIGHT = 1.0f;
+
+//simetricna 4x4 matrica greske (Garland-Heckbert), cuva se samo gornji trougao
+//ravni se dodaju bez tezine, pa je greska zbir kvadrata rastojanja, u jedinicama kvadrata duzine; njen koren je
+//gornja granica rastojanja tacke od svake pojedinacne ravni
+struct Quadric {
+    double m_a2 = 0, m_ab = 0, m_ac = 0, m_ad = 0;
+    double m_b2 = 0, m_bc = 0, m_bd = 0;
+    double m_c2 = 0, m_cd = 0;
+    double m_d2 = 0;
+
+    //ravan a*x + b*y + c*z + d = 0 sa jedinicnom normalom
+    void addPlane(double a, double b, double c, double d) {
+        m_a2 += a * a; m_ab += a * b; m_ac += a * c; m_ad += a * d;
+        m_b2 += b * b; m_bc += b * c; m_bd += b * d;
+        m_c2 += c * c; m_cd += c * d;
+        m_d2 += d * d;
+    }
+
+    void add(const Quadric& other) {
+        m_a2 += other.m_a2; m_ab += other.m_ab; m_ac += other.m_ac; m_ad += other.m_ad;
+        m_b2 += other.m_b2; m_bc += other.m_bc; m_bd += other.m_bd;
+        m_c2 += other.m_c2; m_cd += other.m_cd;
+        m_d2 += other.m_d2;
+    }
+
+    //zbir kvadrata rastojanja tacke od ravni
+    double error(const glm::vec3& point) const {
+        double x = point.x, y = point.y, z = point.z;
+        double result = m_a2 * x * x + m_b2 * y * y + m_c2 * z * z + m_d2
+                      + 2.0 * (m_ab * x * y + m_ac * x * z + m_bc * y * z + m_ad * x + m_bd * y + m_cd * z);
+        return result > 0.0 ? result : 0.0;
+    }
+};
+
+//Manifold - unutrasnji verteks, moze da se spoji sa bilo kojim susedom
+//Border - na otvorenoj ivici, moze da se spoji samo duz te ivice
+//Locked - sav (ista pozicija, drugi UV/normala) ili slozena ivica, nikad se ne uklanja
+enum class SimplifyVertexKind {
+    Manifold,
+    Border,
+    Locked
+};
+
+namespace detail {
+
+inline uint64_t edgeKey(unsigned int from, unsigned int to) {
+    return ((uint64_t) from << 32) | to;
+}
+
+inline glm::vec3 triangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    return glm::cross(b - a, c - a);
+}
+
+inline std::vector<SimplifyVertexKind> classifyVertices(const std::vector<Vertex>& vertices,
+                                                        const std::vector<unsigned int>& indices,
+                                                        const std::unordered_set<uint64_t>& edges) {
+    std::vector<SimplifyVertexKind> kinds(vertices.size(), SimplifyVertexKind::Manifold);
+
+    //verteksi sa istom pozicijom su posle JoinIdenticalVertices razdvojeni samo zbog atributa, sav ostaje netaknut
+    std::vector<unsigned int> order(vertices.size());
+    for (unsigned int i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    auto less = [&](unsigned int a, unsigned int b) {
+        const glm::vec3& pa = vertices[a].m_position;
+        const glm::vec3& pb = vertices[b].m_position;
+        if (pa.x != pb.x) return pa.x < pb.x;
+        if (pa.y != pb.y) return pa.y < pb.y;
+        return pa.z < pb.z;
+    };
+    std::sort(order.begin(), order.end(), less);
+    for (size_t i = 1; i < order.size(); i++) {
+        if (!less(order[i - 1], order[i])) {
+            kinds[order[i - 1]] = SimplifyVertexKind::Locked;
+            kinds[order[i]] = SimplifyVertexKind::Locked;
+        }
+    }
+
+    //ivica bez suprotno orijentisanog para je otvorena; verteks sa tacno jednom ulaznom i izlaznom takvom ivicom je Border
+    std::vector<unsigned char> border_out(vertices.size(), 0), border_in(vertices.size(), 0);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        for (int k = 0; k < 3; k++) {
+            unsigned int from = indices[i + k], to = indices[i + (k + 1) % 3];
+            if (!edges.count(edgeKey(to, from))) {
+                border_out[from] = (unsigned char) std::min(border_out[from] + 1, 2);
+                border_in[to] = (unsigned char) std::min(border_in[to] + 1, 2);
+            }
+        }
+    }
+    for (size_t i = 0; i < vertices.size(); i++) {
+        if (kinds[i] == SimplifyVertexKind::Locked || (border_out[i] == 0 && border_in[i] == 0)) {
+            continue;
+        }
+        kinds[i] = border_out[i] == 1 && border_in[i] == 1 ? SimplifyVertexKind::Border : SimplifyVertexKind::Locked;
+    }
+    return kinds;
+}
+
+//m_cost odredjuje redosled i prag (kvadratna greska i clan normala), m_error je samo kvadratna greska
+struct Collapse {
+    unsigned int m_from;
+    unsigned int m_to;
+    double m_cost;
+    double m_error;
+};
+
+}
+
+//uproscavanje mesh-a kolapsom ivica po kvadratnoj gresci; verteks se uvek spaja u postojeci sused,
+//pa svi nivoi dele isti niz verteksa i zadrzavaju njegove normale i UV koordinate
+//vraca nove indekse sa najvise target_index_count indeksa ako je to moguce bez greske vece od max_error,
+//a u result_error upisuje najvece rastojanje (u jedinicama duzine) primenjenog kolapsa od ravni ulaznih trouglova
+inline std::vector<unsigned int> simplifyMesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                                              size_t target_index_count, float max_error, float& result_error) {
+    result_error = 0.0f;
+    std::vector<unsigned int> result(indices.begin(), indices.end() - indices.size() % 3);
+    if (result.size() <= target_index_count) {
+        return result;
+    }
+
+    std::unordered_set<uint64_t> edges;
+    edges.reserve(result.size());
+    for (size_t i = 0; i < result.size(); i += 3) {
+        for (int k = 0; k < 3; k++) {
+            edges.insert(detail::edgeKey(result[i + k], result[i + (k + 1) % 3]));
+        }
+    }
+    std::vector<SimplifyVertexKind> kinds = detail::classifyVertices(vertices, result, edges);
+
+    //kvadrike ravni trouglova, i ravni normalne na otvorene ivice da bi ivica zadrzala oblik; bez tezina po povrsini
+    //ili duzini, jer bi greska inace rasla sa velicinom trouglova umesto sa odstupanjem povrsine
+    std::vector<Quadric> quadrics(vertices.size());
+    for (size_t i = 0; i < result.size(); i += 3) {
+        const glm::vec3& p0 = vertices[result[i]].m_position;
+        const glm::vec3& p1 = vertices[result[i + 1]].m_position;
+        const glm::vec3& p2 = vertices[result[i + 2]].m_position;
+        glm::vec3 normal = detail::triangleNormal(p0, p1, p2);
+        float area = glm::length(normal);
+        if (area == 0.0f) {
+            continue;
+        }
+        normal /= area;
+
+        Quadric plane;
+        plane.addPlane(normal.x, normal.y, normal.z, -glm::dot(normal, p0));
+        for (int k = 0; k < 3; k++) {
+            quadrics[result[i + k]].add(plane);
+        }
+
+        for (int k = 0; k < 3; k++) {
+            unsigned int from = result[i + k], to = result[i + (k + 1) % 3];
+            if (edges.count(detail::edgeKey(to, from))) {
+                continue;
+            }
+            glm::vec3 edge = vertices[to].m_position - vertices[from].m_position;
+            if (glm::length(edge) == 0.0f) {
+                continue;
+            }
+            glm::vec3 side = glm::normalize(glm::cross(edge, normal));
+            Quadric border;
+            border.addPlane(side.x, side.y, side.z, -glm::dot(side, vertices[from].m_position));
+            quadrics[from].add(border);
+            quadrics[to].add(border);
+        }
+    }
+
+    double max_cost = (double) max_error * max_error;
+    double applied_error = 0.0;
+
+    std::vector<unsigned int> remap(vertices.size());
+    for (unsigned int i = 0; i < remap.size(); i++) {
+        remap[i] = i;
+    }
+
+    std::vector<unsigned int> adjacency_offsets(vertices.size() + 1);
+    std::vector<unsigned int> adjacency;
+    std::vector<detail::Collapse> collapses;
+    std::vector<bool> touched(vertices.size());
+
+    //u svakom prolazu se primenjuju najjeftiniji nezavisni kolapsi, dok se ne dostigne cilj ili greska
+    while (result.size() > target_index_count) {
+
+        //trouglovi oko svakog verteksa
+        std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+        for (unsigned int index : result) {
+            adjacency_offsets[index + 1]++;
+        }
+        for (size_t i = 1; i < adjacency_offsets.size(); i++) {
+            adjacency_offsets[i] += adjacency_offsets[i - 1];
+        }
+        adjacency.resize(result.size());
+        std::vector<unsigned int> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+        for (size_t i = 0; i < result.size(); i++) {
+            adjacency[fill[result[i]]++] = (unsigned int) (i / 3);
+        }
+
+        //kandidati: za svaku ivicu jeftiniji dozvoljeni smer
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                unsigned int a = result[i + k], b = result[i + (k + 1) % 3];
+                bool open = !edges.count(detail::edgeKey(b, a));
+
+                detail::Collapse best{0, 0, -1.0, 0.0};
+                for (int direction = 0; direction < 2; direction++) {
+                    unsigned int from = direction == 0 ? a : b, to = direction == 0 ? b : a;
+                    if (kinds[from] == SimplifyVertexKind::Locked ||
+                        (kinds[from] == SimplifyVertexKind::Border && !open)) {
+                        continue;
+                    }
+
+                    Quadric quadric = quadrics[from];
+                    quadric.add(quadrics[to]);
+                    double error = quadric.error(vertices[to].m_position);
+
+                    //cena zamene normale verteksa normalom cilja, srazmerna kvadratu duzine ivice
+                    glm::vec3 edge = vertices[to].m_position - vertices[from].m_position;
+                    float normal_change = 1.0f - glm::dot(vertices[from].m_normal, vertices[to].m_normal);
+                    double cost = error + LOD_NORMAL_WEIGHT * glm::dot(edge, edge) * std::max(normal_change, 0.0f);
+
+                    if (best.m_cost < 0.0 || cost < best.m_cost) {
+                        best = {from, to, cost, error};
+                    }
+                }
+                if (best.m_cost >= 0.0 && best.m_cost <= max_cost) {
+                    collapses.push_back(best);
+                }
+            }
+        }
+        if (collapses.empty()) {
+            break;
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const detail::Collapse& a, const detail::Collapse& b) { return a.m_cost < b.m_cost; });
+
+        //svaki manifold kolaps uklanja dva trougla; ne uklanja se vise nego sto cilj trazi
+        size_t triangles_to_remove = (result.size() - target_index_count) / 3;
+        size_t collapse_budget = std::max<size_t>(triangles_to_remove / 2, 1);
+
+        std::fill(touched.begin(), touched.end(), false);
+        size_t applied = 0;
+        for (const detail::Collapse& collapse : collapses) {
+            if (applied >= collapse_budget) {
+                break;
+            }
+            if (touched[collapse.m_from] || touched[collapse.m_to]) {
+                continue;
+            }
+
+            //kolaps se odbacuje ako bi neki preostali trougao oko uklonjenog verteksa bio izvrnut ili degenerisan
+            const glm::vec3& target = vertices[collapse.m_to].m_position;
+            bool flips = false;
+            for (unsigned int a = adjacency_offsets[collapse.m_from]; a < adjacency_offsets[collapse.m_from + 1] && !flips; a++) {
+                unsigned int triangle = adjacency[a] * 3;
+                glm::vec3 before[3], after[3];
+                bool contains_target = false;
+                for (int k = 0; k < 3; k++) {
+                    unsigned int index = remap[result[triangle + k]];
+                    contains_target |= index == collapse.m_to;
+                    before[k] = vertices[index].m_position;
+                    after[k] = index == collapse.m_from ? target : before[k];
+                }
+                if (contains_target) {
+                    continue;
+                }
+                glm::vec3 normal_before = detail::triangleNormal(before[0], before[1], before[2]);
+                glm::vec3 normal_after = detail::triangleNormal(after[0], after[1], after[2]);
+                float length_product = glm::length(normal_before) * glm::length(normal_after);
+                flips = length_product == 0.0f || glm::dot(normal_before, normal_after) < 0.25f * length_product;
+            }
+            if (flips) {
+                continue;
+            }
+
+            remap[collapse.m_from] = collapse.m_to;
+            quadrics[collapse.m_to].add(quadrics[collapse.m_from]);
+            touched[collapse.m_from] = true;
+            touched[collapse.m_to] = true;
+            applied_error = std::max(applied_error, collapse.m_error);
+            applied++;
+        }
+        if (applied == 0) {
+            break;
+        }
+
+        //prepisivanje indeksa i izbacivanje degenerisanih trouglova
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            unsigned int a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if (a == b || b == c || a == c) {
+                continue;
+            }
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+
+        //ivice se obnavljaju da bi otvorene ivice posle kolapsa i dalje bile prepoznate
+        edges.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                edges.insert(detail::edgeKey(result[i + k], result[i + (k + 1) % 3]));
+            }
+        }
+    }
+
+    result_error = (float) std::sqrt(applied_error);
+    return result;
+}
+
+//pravi lanac nivoa detalja: nivo k ima najvise 1/2^k trouglova originala i gresku najvise max_relative_error dijagonale
+//svaki nivo se uproscava iz prethodnog, pa mu je greska prema originalu najvise zbir gresaka koraka (nejednakost
+//trougla); taj zbir se cuva u m_lods i ogranicava preostali budzet greske sledecih nivoa
+//indeksi svih nivoa se nadovezuju u m_indices, a m_lods cuva pomeraj, broj indeksa i gresku svakog nivoa
+inline void buildLodChain(MeshData& mesh, float max_relative_error = 0.05f) {
+    size_t base_count = mesh.m_indices.size();
+    mesh.m_lods.clear();
+    mesh.m_lods.push_back({0, (unsigned int) base_count, 0.0f});
+    if (base_count == 0 || !mesh.m_bounds.isValid()) {
+        return;
+    }
+
+    float max_error = glm::length(mesh.m_bounds.m_max - mesh.m_bounds.m_min) * max_relative_error;
+    std::vector<unsigned int> previous(mesh.m_indices.begin(), mesh.m_indices.end());
+    float previous_error = 0.0f;
+
+    for (unsigned int level = 1; level < MAX_LOD_COUNT && previous_error < max_error; level++) {
+        size_t target = (base_count / 3 >> level) * 3;
+        float step_error = 0.0f;
+        std::vector<unsigned int> lod = simplifyMesh(mesh.m_vertices, previous, target, max_error - previous_error, step_error);
+        if (lod.empty() || (float) lod.size() > (float) previous.size() * LOD_MIN_REDUCTION) {
+            break;
+        }
+
+        std::vector<size_t> boundaries;
+        lod = optimizeVertexCache(lod, mesh.m_vertices.size(), boundaries);
+
+        float error = previous_error + step_error;
+        mesh.m_lods.push_back({(unsigned int) mesh.m_indices.size(), (unsigned int) lod.size(), error});
+        mesh.m_indices.insert(mesh.m_indices.end(), lod.begin(), lod.end());
+        previous.swap(lod);
+        previous_error = error;
+    }
+}
+
+}
+
+#endif //PROJECT_BASE_MESHSIMPLIFIER_H
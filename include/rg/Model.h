@@ -11,16 +11,59 @@
 #include <assimp/postprocess.h>
 
 #include <rg/Mesh.h>
+#include <rg/MeshCache.h>
+#include <rg/MeshOptimizer.h>
+#include <rg/Hash.h>
+#include <rg/CullKernel.h>
+#include <rg/FrameStats.h>
+#include <rg/Frustum.h>
+#include <rg/Image.h>
+#include <rg/Lod.h>
+#include <rg/MeshSimplifier.h>
+#include <rg/Placeholder.h>
+#include <rg/RenderQueue.h>
 #include <rg/Shader.h>
+#include <rg/ShaderVariants.h>
+#include <rg/TextureCache.h>
+#include <rg/TextureRegistry.h>
+#include <rg/ThreadPool.h>
 
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <fstream>
+#include <future>
 #include <sstream>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 unsigned int TextureFromFile (const char* path, const std::string &directory);
+unsigned int TextureFromImage (const rg::Image &image, size_t* gpu_bytes = nullptr);
+unsigned int TextureFromCompressed (const rg::CompressedTexture &texture, size_t* gpu_bytes = nullptr);
+
+//ASSIMP flegovi za import, deo su kljuca binarnog kesa mesh-eva
+//bez JoinIdenticalVertices OBJ import daje tri posebna verteksa za svaki trougao, pa kes verteksa ne pomaze
+const unsigned int MODEL_IMPORT_FLAGS = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace |
+                                        aiProcess_JoinIdenticalVertices;
+
+//geometrija modela procitana iz kesa ili preko ASSIMP-a, bez OpenGL objekata
+struct ModelGeometry {
+    bool m_valid = false;
+    bool m_from_cache = false;
+    float m_cold_ms = 0.0f;
+    float m_geometry_ms = 0.0f;
+    std::vector<MeshData> m_meshes;
+};
+
+//Blocking - konstruktor ceka da sve bude na GPU-u
+//Async - konstruktor se odmah vraca, model se ucitava na radnim nitima i salje na GPU kroz Update()
+enum class ModelLoading {
+    Blocking,
+    Async
+};
 
 class Model {
 public:
@@ -29,73 +72,461 @@ public:
     std::vector<Texture> m_textures_loaded;
     std::vector<Mesh> m_meshes;
     std::string m_directory;
+    rg::AABB m_bounds;
+    rg::Sphere m_sphere;
+
+    //broj mesh-eva koje Update() najvise salje na GPU po pozivu
+    unsigned int m_upload_budget = 1;
 
     //konstruktor
-    Model (std::string const &path) {
-        loadModel(path);
+    Model (std::string const &path, ModelLoading loading = ModelLoading::Blocking,
+           rg::VertexFormat vertex_format = rg::VertexFormat::Packed) {
+        m_path = path;
+        m_vertex_format = vertex_format;
+        m_start = std::chrono::steady_clock::now();
+
+        //dobijanje putanje direktorijuma
+        m_directory = path.substr(0, path.find_last_of('/'));
+
+        if (loading == ModelLoading::Async) {
+            //dok geometrija nije poznata crta se jedinicna kocka
+            rg::AABB unit;
+            unit.extend(glm::vec3(-0.5f));
+            unit.extend(glm::vec3(0.5f));
+            addPlaceholder(unit);
+
+            m_pending_geometry = rg::ThreadPool::instance().submit([path] { return loadGeometry(path); });
+        } else {
+            beginTextureLoading(loadGeometry(path));
+            uploadMeshes((unsigned int) m_pending_meshes.size(), true);
+        }
     }
 
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
+
+    ~Model() {
+        releasePlaceholders();
+        for (Mesh& mesh : m_meshes) {
+            mesh.Release();
+        }
+        if (m_instance_buffer != 0) {
+            glDeleteBuffers(1, &m_instance_buffer);
+        }
+        for (const Texture& texture : m_textures_loaded) {
+            rg::TextureRegistry::instance().release(texture.m_id);
+        }
+    }
+
+    //napreduje asinhrono ucitavanje, poziva se jednom po frejmu sa GL niti
+    void Update() {
+        if (m_pending_geometry.valid() &&
+            m_pending_geometry.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            beginTextureLoading(m_pending_geometry.get());
+        }
+        uploadMeshes(m_upload_budget, false);
+    }
+
+    //true kada su svi mesh-evi i njihove teksture na GPU-u
+    bool IsResident() const {
+        return m_resident;
+    }
+
+    //crta mesh-eve koji su na GPU-u i placeholder-e umesto onih koji jos nisu
     void Draw(Shader &shader) {
         for (unsigned int i = 0; i < m_meshes.size(); i++) {
             m_meshes[i].Draw(shader);
         }
+        for (unsigned int i = placeholderStart(); i < m_placeholders.size(); i++) {
+            m_placeholders[i].Draw(shader);
+        }
+    }
+
+    //postavlja "model" uniform i crta svaki mesh na nivou detalja koji bira selector
+    //sa zadatim frustum-om se preskacu model i mesh-evi van pogleda
+    void Draw(Shader &shader, const glm::mat4& model, const rg::LodSelector& selector,
+              const rg::Frustum* frustum = nullptr) {
+        if (frustum && !IsVisible(model, *frustum)) {
+            rg::FrameStats::instance().recordCulling(0, 1);
+            return;
+        }
+        rg::FrameStats::instance().recordCulling(1, 0);
+        shader.setMat4(rg::MODEL_UNIFORM, model);
+
+        float scale = maxScale(model);
+        for (unsigned int i = 0; i < m_meshes.size(); i++) {
+            rg::Sphere sphere = m_meshes[i].m_sphere.transformed(model);
+            if (frustum && !frustum->intersects(sphere))
+                continue;
+            m_meshes[i].Draw(shader, selector.select(m_meshes[i].m_lods, sphere, scale));
+        }
+        for (unsigned int i = placeholderStart(); i < m_placeholders.size(); i++) {
+            m_placeholders[i].Draw(shader);
+        }
+    }
+
+    //crta count kopija modela sa jednim instanciranim pozivom po mesh-u i nivou detalja
+    //shader cita model matricu iz atributa na INSTANCE_MATRIX_LOCATION umesto iz "model" uniform-a
+    void DrawInstanced(Shader &shader, const glm::mat4* models, size_t count,
+                       const rg::LodSelector& selector = rg::LodSelector(), const rg::Frustum* frustum = nullptr) {
+        if (!prepareInstances(models, count, selector, frustum))
+            return;
+
+        for (const InstanceBatch& batch : m_instance_batches) {
+            m_meshes[batch.m_mesh].DrawInstanced(shader, m_instance_buffer, batch.m_first * sizeof(glm::mat4),
+                                                 (unsigned int) batch.m_count, batch.m_lod);
+        }
+        for (unsigned int i = placeholderStart(); i < m_placeholders.size(); i++) {
+            m_placeholders[i].DrawInstanced(shader, m_instance_buffer, m_placeholder_first * sizeof(glm::mat4),
+                                            (unsigned int) m_visible_instances.size());
+        }
+    }
+
+    //isto kao Draw, ali pozive dodaje u red koji ih sortira i salje kasnije
+    //svaki mesh dobija najjeftiniju varijantu: features (svetla, instanciranje) uz osobine koje trazi njegov materijal
+    void Submit(rg::RenderQueue &queue, rg::ShaderVariants &shaders, uint32_t features, const glm::mat4& model,
+                const rg::LodSelector& selector, const rg::Frustum* frustum = nullptr) {
+        if (frustum && !IsVisible(model, *frustum)) {
+            rg::FrameStats::instance().recordCulling(0, 1);
+            return;
+        }
+        rg::FrameStats::instance().recordCulling(1, 0);
+
+        float scale = maxScale(model);
+        for (unsigned int i = 0; i < m_meshes.size(); i++) {
+            rg::Sphere sphere = m_meshes[i].m_sphere.transformed(model);
+            if (frustum && !frustum->intersects(sphere))
+                continue;
+            queue.push(shaders, features | m_meshes[i].m_shader_features, m_meshes[i],
+                       selector.select(m_meshes[i].m_lods, sphere, scale), model, sphere.m_center);
+        }
+        glm::vec3 center = glm::vec3(model * glm::vec4(m_sphere.m_center, 1.0f));
+        for (unsigned int i = placeholderStart(); i < m_placeholders.size(); i++) {
+            queue.push(shaders, features, m_placeholders[i], 0, model, center);
+        }
+    }
+
+    //isto kao DrawInstanced; matrice se salju odmah i cuvaju do sledeceg begin-a reda, pa se model sme predati redu
+    //najvise jednom po frejmu; za vise prolaza se isti paketi salju vise puta (RenderQueue::submit sa varijantama prolaza)
+    //dubina instanciranog poziva je dubina najblize instance u njemu
+    void SubmitInstanced(rg::RenderQueue &queue, rg::ShaderVariants &shaders, uint32_t features, const glm::mat4* models,
+                         size_t count, const rg::LodSelector& selector = rg::LodSelector(),
+                         const rg::Frustum* frustum = nullptr) {
+        if (!prepareInstances(models, count, selector, frustum))
+            return;
+
+        for (const InstanceBatch& batch : m_instance_batches) {
+            Mesh& mesh = m_meshes[batch.m_mesh];
+            queue.pushInstanced(shaders, features | mesh.m_shader_features, mesh, batch.m_lod, m_instance_buffer, batch.m_first * sizeof(glm::mat4),
+                                (unsigned int) batch.m_count, &m_instance_matrices[batch.m_first],
+                                nearestCenter(mesh.m_sphere.m_center, &m_instance_matrices[batch.m_first], batch.m_count,
+                                              queue.cameraPosition()));
+        }
+        glm::vec3 center = nearestCenter(m_sphere.m_center, m_visible_instances.data(), m_visible_instances.size(),
+                                         queue.cameraPosition());
+        for (unsigned int i = placeholderStart(); i < m_placeholders.size(); i++) {
+            queue.pushInstanced(shaders, features, m_placeholders[i], 0, m_instance_buffer, m_placeholder_first * sizeof(glm::mat4),
+                                (unsigned int) m_visible_instances.size(), &m_instance_matrices[m_placeholder_first], center);
+        }
+    }
+
+    //da li je model sa datom matricom bar delom u pogledu; dok geometrija nije poznata uvek jeste
+    bool IsVisible(const glm::mat4& model, const rg::Frustum& frustum) const {
+        if (!m_bounds.isValid())
+            return true;
+        return frustum.intersects(m_sphere.transformed(model)) && frustum.intersects(m_bounds.transformed(model));
     }
 
     void SetShaderTextureNamePrefix(std::string prefix) {
+        m_texture_prefix = prefix;
         for (Mesh& mesh : m_meshes) {
-            mesh.m_glslIdentifierPrefix = prefix;
+            mesh.SetTextureNamePrefix(prefix);
+        }
+        for (Mesh& mesh : m_placeholders) {
+            mesh.SetTextureNamePrefix(prefix);
         }
     }
 
 private:
 
-    //ucitavanje modela sa podrzanom ekstenzijom fajla i cuvanje mesh-ova u vektor
-    void loadModel (std::string const &path) {
+    std::string m_path;
+    std::string m_texture_prefix;
+    rg::VertexFormat m_vertex_format;
+    std::chrono::steady_clock::time_point m_start;
+    bool m_resident = false;
+
+    //stanje ucitavanja: geometrija na radnoj niti, zatim dekodiranje tekstura, pa slanje mesh-eva na GPU
+    std::future<ModelGeometry> m_pending_geometry;
+    ModelGeometry m_geometry_info;
+    std::vector<MeshData> m_pending_meshes;
+    std::unordered_map<std::string, std::shared_future<rg::CompressedTexture>> m_pending_textures;
+
+    //kanonske putanje tekstura iz materijala i id-jevi tekstura koje je model vec preuzeo iz registra
+    std::unordered_map<std::string, std::string> m_canonical_paths;
+    std::unordered_map<std::string, unsigned int> m_texture_ids;
+
+    //placeholder za svaki mesh koji jos nije na GPU-u, i-ti placeholder odgovara i-tom mesh-u
+    std::vector<Mesh> m_placeholders;
+
+    //instancirano crtanje: opseg matrica u m_instance_buffer za jedan mesh i nivo detalja
+    struct InstanceBatch {
+        unsigned int m_mesh;
+        unsigned int m_lod;
+        size_t m_first;
+        size_t m_count;
+    };
+    unsigned int m_instance_buffer = 0;
+    std::vector<glm::mat4> m_instance_matrices;
+    std::vector<InstanceBatch> m_instance_batches;
+    std::vector<glm::mat4> m_visible_instances;
+    rg::BoundsStore m_instance_bounds;
+    std::vector<uint8_t> m_sphere_visible;
+    std::vector<uint8_t> m_box_visible;
+    std::vector<unsigned int> m_instance_lods;
+    size_t m_placeholder_first = 0;
+
+    //hes izvornog fajla, ASSIMP flegova i svake biblioteke materijala (mtllib) koju .obj navodi, jer kes cuva i
+    //reference tekstura procitane iz materijala; biblioteka koja ne postoji ulazi u hes samo imenom
+    //ASSIMP uzima ostatak linije kao ime fajla, pa ime sme da sadrzi razmake ("dom 1.mtl")
+    static uint64_t sourceHash(const std::string& path) {
+        rg::MappedFile file(path);
+        if (!file.isOpen()) {
+            return 0;
+        }
+        const char* data = reinterpret_cast<const char*>(file.data());
+        size_t size = file.size();
+        uint64_t hash = rg::hashFnv1a64(data, size);
+        hash = rg::hashFnv1a64(&MODEL_IMPORT_FLAGS, sizeof(MODEL_IMPORT_FLAGS), hash);
+
+        std::string directory = path.substr(0, path.find_last_of('/'));
+        const char* end = data + size;
+        for (const char* line = data; line < end; ) {
+            const char* line_end = std::find(line, end, '\n');
+            const size_t KEYWORD = 7;
+            if ((size_t) (line_end - line) > KEYWORD && std::equal(line, line + KEYWORD, "mtllib ")) {
+                std::string name(line + KEYWORD, line_end);
+                size_t first = name.find_first_not_of(" \t");
+                size_t last = name.find_last_not_of(" \t\r");
+                if (first != std::string::npos) {
+                    std::string library = directory + '/' + name.substr(first, last - first + 1);
+                    hash = rg::hashString(library.c_str(), hash);
+                    rg::MappedFile material(library);
+                    if (material.isOpen()) {
+                        hash = rg::hashFnv1a64(material.data(), material.size(), hash);
+                    }
+                }
+            }
+            line = line_end + 1;
+        }
+        return hash;
+    }
 
-        //citanje fajla preko ASSIMP-a
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(path,  aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+    //ucitavanje geometrije sa podrzanom ekstenzijom fajla, ne koristi OpenGL pa moze na radnoj niti
+    static ModelGeometry loadGeometry (std::string const &path) {
 
-        //provera da li je doslo do greske
-        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-            std::cerr << "ERROR::ASSIMP::" << importer.GetErrorString() << "\n";
+        auto start = std::chrono::steady_clock::now();
+        ModelGeometry geometry;
+
+        //kes je validan samo za isti sadrzaj izvornog fajla, njegovih biblioteka materijala i iste ASSIMP flegove
+        std::string cache_path = path + ".meshcache";
+        uint64_t source_hash = sourceHash(path);
+
+        geometry.m_from_cache = rg::MeshCache::read(cache_path, source_hash, MODEL_IMPORT_FLAGS, geometry.m_meshes, geometry.m_cold_ms);
+
+        if (!geometry.m_from_cache) {
+
+            //citanje fajla preko ASSIMP-a
+            Assimp::Importer importer;
+            const aiScene* scene = importer.ReadFile(path, MODEL_IMPORT_FLAGS);
+
+            //provera da li je doslo do greske
+            if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+                std::cerr << "ERROR::ASSIMP::" << importer.GetErrorString() << "\n";
+                return geometry;
+            }
+
+            //obrada ASSIMP-ovih cvorova rekurzivno
+            processNode(scene->mRootNode, scene, geometry.m_meshes);
+
+            //redosled indeksa i verteksa za GPU se odredjuje jednom, pre upisa u kes
+            //mesh-evi koji tek malo prelaze 65536 verteksa se dele da bi svi delovi mogli da koriste 16-bitne indekse
+            std::vector<MeshData> meshes;
+            for (unsigned int i = 0; i < geometry.m_meshes.size(); i++) {
+                rg::MeshOptimizationStats stats = rg::optimizeMesh(geometry.m_meshes[i]);
+                std::cout << "Model " << path << ", mesh " << i << ": ACMR " << stats.m_before.m_acmr << " -> " << stats.m_after.m_acmr
+                          << ", ATVR " << stats.m_before.m_atvr << " -> " << stats.m_after.m_atvr << "\n";
+
+                std::vector<MeshData> parts;
+                if (rg::splitForIndex16(geometry.m_meshes[i], parts)) {
+                    std::cout << "Model " << path << ", mesh " << i << ": " << geometry.m_meshes[i].m_vertices.size()
+                              << " verteksa podeljeno na " << parts.size() << " dela sa 16-bitnim indeksima\n";
+                    for (MeshData& part : parts) {
+                        meshes.push_back(std::move(part));
+                    }
+                } else {
+                    meshes.push_back(std::move(geometry.m_meshes[i]));
+                }
+            }
+            geometry.m_meshes.swap(meshes);
+
+            //nivoi detalja se prave posle deljenja, pa svi nivoi dela koriste isti niz verteksa
+            for (unsigned int i = 0; i < geometry.m_meshes.size(); i++) {
+                rg::buildLodChain(geometry.m_meshes[i]);
+                std::cout << "Model " << path << ", mesh " << i << ": LOD trouglovi";
+                for (const MeshLod& lod : geometry.m_meshes[i].m_lods) {
+                    std::cout << " " << lod.m_index_count / 3 << " (" << lod.m_error << ")";
+                }
+                std::cout << "\n";
+            }
+
+            geometry.m_cold_ms = millisecondsSince(start);
+            rg::MeshCache::write(cache_path, source_hash, MODEL_IMPORT_FLAGS, geometry.m_meshes, geometry.m_cold_ms);
+        }
+
+        geometry.m_geometry_ms = millisecondsSince(start);
+        geometry.m_valid = true;
+        return geometry;
+    }
+
+    //geometrija je poznata: placeholder-i dobijaju prave granice i pocinje dekodiranje tekstura
+    void beginTextureLoading (ModelGeometry geometry) {
+
+        releasePlaceholders();
+        m_pending_meshes.swap(geometry.m_meshes);
+        m_geometry_info = std::move(geometry);
+
+        for (const MeshData& data : m_pending_meshes) {
+            m_bounds.extend(data.m_bounds);
+            addPlaceholder(data.m_bounds);
+        }
+        m_sphere.m_center = m_bounds.center();
+        for (const MeshData& data : m_pending_meshes) {
+            m_sphere.include(data.m_sphere);
+        }
+
+        //sve teksture koje nisu u registru se citaju iz kesa (ili kompresuju) paralelno na radnim nitima,
+        //glavna nit ih samo salje na GPU
+        for (const MeshData& data : m_pending_meshes) {
+            for (const Texture& texture : data.m_textures) {
+                std::string key = textureKey(texture);
+                if (!rg::TextureRegistry::instance().contains(key) &&
+                    m_pending_textures.find(key) == m_pending_textures.end())
+                    m_pending_textures.emplace(key, rg::loadCompressedTextureAsync(canonicalPath(texture.m_path), textureUsage(texture)));
+            }
+        }
+
+        if (!m_geometry_info.m_valid)
+            m_resident = true;
+    }
+
+    //salje na GPU najvise budget mesh-eva, redom; bez cekanja se staje kod prvog cije teksture nisu dekodirane
+    void uploadMeshes (unsigned int budget, bool wait) {
+
+        if (m_resident || m_pending_geometry.valid())
             return;
+
+        unsigned int uploaded = 0;
+        while (m_meshes.size() < m_pending_meshes.size() && uploaded < budget) {
+            MeshData& data = m_pending_meshes[m_meshes.size()];
+            if (!wait && !texturesDecoded(data))
+                break;
+
+            std::vector<Texture> textures = loadTextures(data.m_textures);
+            Mesh mesh(std::move(data.m_vertices), std::move(data.m_indices), textures, m_vertex_format, std::move(data.m_lods));
+            mesh.m_bounds = data.m_bounds;
+            mesh.m_sphere = data.m_sphere;
+            mesh.SetTextureNamePrefix(m_texture_prefix);
+            mesh.m_shader_features = shaderFeatures(textures);
+            m_placeholders[m_meshes.size()].Release();
+            m_meshes.push_back(mesh);
+            uploaded++;
         }
 
-        //dobijanje putanje direktorijuma
-        m_directory = path.substr(0, path.find_last_of('/'));
+        if (m_meshes.size() == m_pending_meshes.size()) {
+            m_resident = true;
+            m_placeholders.clear();
+            m_pending_meshes.clear();
+            m_pending_textures.clear();
+            m_canonical_paths.clear();
+
+            std::cout << "Model " << m_path << ": geometrija " << m_geometry_info.m_geometry_ms << " ms";
+            if (m_geometry_info.m_from_cache)
+                std::cout << " (kes, ASSIMP import " << m_geometry_info.m_cold_ms << " ms)";
+            else
+                std::cout << " (ASSIMP import, kes upisan)";
+            std::cout << ", na GPU-u posle " << millisecondsSince(m_start) << " ms\n";
+
+            size_t vertex_bytes = 0, full_bytes = 0, index_bytes = 0, full_index_bytes = 0;
+            for (const Mesh& mesh : m_meshes) {
+                vertex_bytes += mesh.m_vertex_bytes;
+                full_bytes += mesh.m_vertices.size() * sizeof(Vertex);
+                index_bytes += mesh.m_index_bytes;
+                full_index_bytes += mesh.m_indices.size() * sizeof(unsigned int);
+            }
+            std::cout << "Model " << m_path << ": verteksi " << vertex_bytes / 1024 << " KB (float32 "
+                      << full_bytes / 1024 << " KB), indeksi " << index_bytes / 1024 << " KB (32-bit "
+                      << full_index_bytes / 1024 << " KB)\n";
+        }
+    }
 
-        //obrada ASSIMP-ovih cvorova rekurzivno
-        processNode(scene->mRootNode, scene);
+    bool texturesDecoded (const MeshData& data) {
+        for (const Texture& texture : data.m_textures) {
+            auto pending = m_pending_textures.find(textureKey(texture));
+            if (pending != m_pending_textures.end() &&
+                pending->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                return false;
+        }
+        return true;
+    }
+
+    void addPlaceholder (const rg::AABB& bounds) {
+        MeshData data = rg::placeholderBox(bounds);
+        Mesh mesh(data.m_vertices, data.m_indices, data.m_textures);
+        mesh.m_bounds = bounds;
+        mesh.m_sphere = data.m_sphere;
+        mesh.SetTextureNamePrefix(m_texture_prefix);
+        m_placeholders.push_back(mesh);
+    }
+
+    void releasePlaceholders () {
+        for (unsigned int i = placeholderStart(); i < m_placeholders.size(); i++) {
+            m_placeholders[i].Release();
+        }
+        m_placeholders.clear();
+    }
 
+    //placeholder-i mesh-eva koji su vec na GPU-u su oslobodjeni
+    unsigned int placeholderStart () const {
+        return m_pending_geometry.valid() ? 0 : (unsigned int) m_meshes.size();
     }
 
     //obrada cvorova rekuzivno
-    void processNode (aiNode* node, const aiScene* scene) {
+    static void processNode (aiNode* node, const aiScene* scene, std::vector<MeshData>& meshes) {
 
         //obrada svakog mesh-a u trenutnom cvoru
         for (unsigned int i = 0; i < node->mNumMeshes; i++) {
             aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            m_meshes.push_back(processMesh(mesh, scene));
+            meshes.push_back(processMesh(mesh, scene));
         }
 
         //obrada svih dete-cvorova rekurzivno
         for (unsigned int i = 0; i < node->mNumChildren; i++) {
-            processNode(node->mChildren[i], scene);
+            processNode(node->mChildren[i], scene, meshes);
         }
 
     }
 
-    Mesh processMesh (aiMesh* mesh, const aiScene* scene) {
+    static MeshData processMesh (aiMesh* mesh, const aiScene* scene) {
 
-        std::vector<Vertex> vertices;
-        std::vector<unsigned int> indices;
-        std::vector<Texture> textures;
+        MeshData data;
+        std::vector<Vertex>& vertices = data.m_vertices;
+        std::vector<unsigned int>& indices = data.m_indices;
+        std::vector<Texture>& textures = data.m_textures;
 
         //prolazenje svih vertexa mesh-a
         for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
 
-            Vertex vertex;
+            Vertex vertex{};
             glm::vec3 vector;
 
             //koordinate
@@ -103,6 +534,7 @@ private:
             vector.y = mesh->mVertices[i].y;
             vector.z = mesh->mVertices[i].z;
             vertex.m_position = vector;
+            data.m_bounds.extend(vector);
 
             //normale
             if (mesh->HasNormals()) {
@@ -140,6 +572,12 @@ private:
             vertices.push_back(vertex);
         }
 
+        //sfera oko centra AABB-a, poznatog tek posle svih verteksa
+        data.m_sphere.m_center = data.m_bounds.center();
+        for (const Vertex& vertex : vertices) {
+            data.m_sphere.include(vertex.m_position);
+        }
+
         //prolazenje kroz sve face-ove mesh-a
         for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
             aiFace face = mesh->mFaces[i];
@@ -154,93 +592,310 @@ private:
         material->Get(AI_MATKEY_COLOR_AMBIENT, color);
 
         // 1. difuzna mapa
-        std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
+        std::vector<Texture> diffuseMaps = materialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
         textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
         // 2. spekularna mapa
-        std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
+        std::vector<Texture> specularMaps = materialTextures(material, aiTextureType_SPECULAR, "texture_specular");
         textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
         // 3. normalna mapa
-        std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
+        std::vector<Texture> normalMaps = materialTextures(material, aiTextureType_HEIGHT, "texture_normal");
         textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
         // 4. height mapa
-        std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
+        std::vector<Texture> heightMaps = materialTextures(material, aiTextureType_AMBIENT, "texture_height");
         textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
 
-        return Mesh(vertices, indices, textures);
+        return data;
     }
 
-    //preoverava sve teksture datog tipa i ucitava teksturu ako nije vec ucitana
-    std::vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string type_name) {
+    //reference na sve teksture datog tipa iz materijala, same teksture se ucitavaju kasnije
+    static std::vector<Texture> materialTextures(aiMaterial* mat, aiTextureType type, std::string type_name) {
         std::vector<Texture> textures;
         for (unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
             aiString str;
             mat->GetTexture(type, i, &str);
 
-            bool skip = false;
-            for (unsigned int j = 0; j < m_textures_loaded.size(); j++) {
-                if (std::strcmp(m_textures_loaded[j].m_path.data(), str.C_Str()) == 0) {
-                    textures.push_back(m_textures_loaded[j]);
-                    skip = true;
-                    break;
-                }
-            }
+            Texture texture;
+            texture.m_id = 0;
+            texture.m_type = type_name;
+            texture.m_path = str.C_Str();
+            textures.push_back(texture);
+        }
+
+        return textures;
+
+    }
+
+    //kanonska putanja teksture iz materijala, racuna se jednom po teksturi
+    const std::string& canonicalPath(const std::string& path) {
+        auto it = m_canonical_paths.find(path);
+        if (it == m_canonical_paths.end()) {
+            it = m_canonical_paths.emplace(path, rg::TextureRegistry::canonicalPath(m_directory + '/' + path)).first;
+        }
+        return it->second;
+    }
+
+    //alfa test samo za providne difuzne teksture, normalne mape samo za formate sa tangentom
+    uint32_t shaderFeatures(const std::vector<Texture>& textures) const {
+        uint32_t features = 0;
+        bool tangents = rg::hasTangent(m_vertex_format);
+        for (const Texture& texture : textures) {
+            if (texture.m_type == "texture_diffuse" && rg::TextureRegistry::instance().hasAlpha(texture.m_id))
+                features |= rg::SHADER_ALPHA_TEST;
+            if (texture.m_type == "texture_normal" && tangents)
+                features |= rg::SHADER_NORMAL_MAP;
+        }
+        return features;
+    }
+
+    static rg::TextureUsage textureUsage(const Texture& reference) {
+        return reference.m_type == "texture_normal" ? rg::TextureUsage::Normal : rg::TextureUsage::Color;
+    }
+
+    //kljuc u registru; ista slika kao normalna mapa je druga tekstura jer je drugacije kompresovana
+    std::string textureKey(const Texture& reference) {
+        const std::string& canonical = canonicalPath(reference.m_path);
+        return textureUsage(reference) == rg::TextureUsage::Normal ? canonical + "#normal" : canonical;
+    }
+
+    //preuzima teksture iz globalnog registra, a one kojih nema salje na GPU i dodaje u registar
+    std::vector<Texture> loadTextures(const std::vector<Texture>& references) {
+        rg::TextureRegistry& registry = rg::TextureRegistry::instance();
 
-            if (!skip) {
-                Texture texture;
-                texture.m_id = TextureFromFile(str.C_Str(), this->m_directory);
-                texture.m_type = type_name;
-                texture.m_path = str.C_Str();
-                textures.push_back(texture);
+        std::vector<Texture> textures;
+        for (const Texture& reference : references) {
+            std::string key = textureKey(reference);
+
+            Texture texture = reference;
+            auto loaded = m_texture_ids.find(key);
+            if (loaded != m_texture_ids.end()) {
+                texture.m_id = loaded->second;
+            } else {
+                texture.m_id = registry.acquire(key);
+                if (texture.m_id == 0) {
+                    //u medjuvremenu je mozda neki drugi model oslobodio teksturu, pa citanje nije ni pokrenuto
+                    auto pending = m_pending_textures.find(key);
+                    rg::CompressedTexture compressed = pending != m_pending_textures.end()
+                            ? pending->second.get()
+                            : rg::TextureCache::load(canonicalPath(reference.m_path), textureUsage(reference));
+                    size_t gpu_bytes = 0;
+                    texture.m_id = TextureFromCompressed(compressed, &gpu_bytes);
+                    registry.insert(key, texture.m_id, gpu_bytes, compressed.uncompressedBytes(), compressed.hasAlpha());
+                }
+                m_texture_ids.emplace(key, texture.m_id);
                 m_textures_loaded.push_back(texture);
             }
+            textures.push_back(texture);
         }
 
         return textures;
 
     }
 
+    //odbacuje instance van pogleda, sortira ih po mesh-u i nivou detalja i salje matrice u m_instance_buffer
+    //false ako nema sta da se crta
+    bool prepareInstances(const glm::mat4* models, size_t count, const rg::LodSelector& selector,
+                          const rg::Frustum* frustum) {
+
+        //instance van pogleda se odbacuju pre sortiranja, SIMD testom sfera i AABB-ova u svetu
+        m_visible_instances.clear();
+        if (frustum && m_bounds.isValid()) {
+            m_instance_bounds.clear();
+            m_instance_bounds.reserve(count);
+            for (size_t j = 0; j < count; j++) {
+                m_instance_bounds.add(m_bounds.transformed(models[j]), m_sphere.transformed(models[j]));
+            }
+            m_sphere_visible.resize(count);
+            m_box_visible.resize(count);
+            rg::cullSpheres(m_instance_bounds, *frustum, m_sphere_visible.data());
+            rg::cullBoxes(m_instance_bounds, *frustum, m_box_visible.data());
+            for (size_t j = 0; j < count; j++) {
+                if (m_sphere_visible[j] && m_box_visible[j]) {
+                    m_visible_instances.push_back(models[j]);
+                }
+            }
+        } else {
+            m_visible_instances.assign(models, models + count);
+        }
+        rg::FrameStats::instance().recordCulling(m_visible_instances.size(), count - m_visible_instances.size());
+        if (m_visible_instances.empty())
+            return false;
+
+        //za svaki mesh instance se sortiraju po nivou detalja u uzastopne opsege jednog bafera
+        //mesh instance van pogleda dobija nivo CULLED_LOD i ne ulazi u bafer
+        const unsigned int CULLED_LOD = ~0u;
+        m_instance_matrices.clear();
+        m_instance_batches.clear();
+        m_instance_lods.resize(m_visible_instances.size());
+        for (unsigned int i = 0; i < m_meshes.size(); i++) {
+            const Mesh& mesh = m_meshes[i];
+            std::vector<size_t> lod_counts(mesh.m_lods.size(), 0);
+            for (size_t j = 0; j < m_visible_instances.size(); j++) {
+                rg::Sphere sphere = mesh.m_sphere.transformed(m_visible_instances[j]);
+                if (frustum && !frustum->intersects(sphere)) {
+                    m_instance_lods[j] = CULLED_LOD;
+                    continue;
+                }
+                m_instance_lods[j] = selector.select(mesh.m_lods, sphere, maxScale(m_visible_instances[j]));
+                lod_counts[m_instance_lods[j]]++;
+            }
+
+            size_t first = m_instance_matrices.size();
+            for (unsigned int lod = 0; lod < lod_counts.size(); lod++) {
+                if (lod_counts[lod] > 0) {
+                    m_instance_batches.push_back({i, lod, first, lod_counts[lod]});
+                }
+                size_t next = first + lod_counts[lod];
+                lod_counts[lod] = first;
+                first = next;
+            }
+            m_instance_matrices.resize(first);
+            for (size_t j = 0; j < m_visible_instances.size(); j++) {
+                if (m_instance_lods[j] != CULLED_LOD) {
+                    m_instance_matrices[lod_counts[m_instance_lods[j]]++] = m_visible_instances[j];
+                }
+            }
+        }
+
+        //placeholder-i nemaju nivoe detalja, koriste vidljive matrice redom
+        m_placeholder_first = m_instance_matrices.size();
+        if (placeholderStart() < m_placeholders.size()) {
+            m_instance_matrices.insert(m_instance_matrices.end(), m_visible_instances.begin(), m_visible_instances.end());
+        }
+        if (m_instance_matrices.empty())
+            return false;
+
+        if (m_instance_buffer == 0) {
+            glGenBuffers(1, &m_instance_buffer);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, m_instance_buffer);
+        glBufferData(GL_ARRAY_BUFFER, m_instance_matrices.size() * sizeof(glm::mat4), m_instance_matrices.data(), GL_STREAM_DRAW);
+
+        return true;
+    }
+
+    //centar (u prostoru modela) preslikan matricom instance najblize kameri
+    static glm::vec3 nearestCenter(const glm::vec3& center, const glm::mat4* models, size_t count,
+                                   const glm::vec3& camera_position) {
+        glm::vec3 nearest = center;
+        float nearest_distance = std::numeric_limits<float>::max();
+        for (size_t j = 0; j < count; j++) {
+            glm::vec3 world = glm::vec3(models[j] * glm::vec4(center, 1.0f));
+            float distance = glm::dot(world - camera_position, world - camera_position);
+            if (distance < nearest_distance) {
+                nearest_distance = distance;
+                nearest = world;
+            }
+        }
+        return nearest;
+    }
+
+    //najvece skaliranje po osi, za poluprecnik sfere oko transformisanog mesh-a
+    static float maxScale (const glm::mat4& model) {
+        return std::max(glm::length(glm::vec3(model[0])),
+                        std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    }
+
+    static float millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
 };
 
 unsigned int TextureFromFile(const char* path, const std::string& directory)
 {
-    std::cout << std::string(path) << "\n";
     std::string filename = std::string(path);
     filename = directory + '/' + filename;
 
+    return TextureFromImage(rg::decodeImage(filename));
+}
+
+unsigned int TextureFromImage(const rg::Image& image, size_t* gpu_bytes)
+{
+    std::cout << image.m_path << "\n";
+
     unsigned int textureID;
     glGenTextures(1, &textureID);
 
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
+    if (image.isValid())
     {
         GLenum format;
-        if (nrComponents == 1)
+        if (image.m_components == 1)
             format = GL_RED;
-        else if (nrComponents == 3)
+        else if (image.m_components == 3)
             format = GL_RGB;
-        else if (nrComponents == 4)
+        else if (image.m_components == 4)
             format = GL_RGBA;
 
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.m_width, image.m_height, 0, format, GL_UNSIGNED_BYTE, image.m_data.get());
         glGenerateMipmap(GL_TEXTURE_2D);
 
+        //velicina svih mipmap nivoa, bez dopune koju drajver eventualno dodaje
+        if (gpu_bytes) {
+            *gpu_bytes = 0;
+            for (int width = image.m_width, height = image.m_height; ; width = std::max(1, width / 2), height = std::max(1, height / 2)) {
+                *gpu_bytes += (size_t) width * height * image.m_components;
+                if (width == 1 && height == 1)
+                    break;
+            }
+        }
+
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
     }
     else
     {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+        std::cout << "Texture failed to load at path: " << image.m_path << std::endl;
     }
 
     return textureID;
 }
 
+unsigned int TextureFromCompressed(const rg::CompressedTexture& texture, size_t* gpu_bytes)
+{
+    std::cout << texture.m_path << (texture.m_from_cache ? " (kes)" : " (kompresovano)") << "\n";
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+
+    if (texture.isValid())
+    {
+        glBindTexture(GL_TEXTURE_2D, textureID);
+
+        //svi mipmap nivoi su vec izracunati, glGenerateMipmap nije potreban
+        bool hardware = rg::isBlockFormatSupported(texture.m_format);
+        size_t bytes = 0;
+        for (unsigned int i = 0; i < texture.m_levels.size(); i++)
+        {
+            const rg::TextureLevel& level = texture.m_levels[i];
+            if (hardware) {
+                glCompressedTexImage2D(GL_TEXTURE_2D, i, rg::glInternalFormat(texture.m_format), level.m_width, level.m_height, 0,
+                                       (GLsizei) level.m_data.size(), level.m_data.data());
+                bytes += level.m_data.size();
+            } else {
+                std::vector<unsigned char> rgba = rg::TextureCache::decompressLevel(level, texture.m_format);
+                glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, level.m_width, level.m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+                bytes += rgba.size();
+            }
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint) texture.m_levels.size() - 1);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        if (gpu_bytes)
+            *gpu_bytes = bytes;
+    }
+    else
+    {
+        std::cout << "Texture failed to load at path: " << texture.m_path << std::endl;
+    }
+
+    return textureID;
+}
 
 #endif
\ No newline at end of file
@@ -0,0 +1,258 @@
+#ifndef PROJECT_BASE_MULTIDRAWINDIRECT_H
+#define PROJECT_BASE_MULTIDRAWINDIRECT_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/FrameStats.h>
+#include <rg/GlStateCache.h>
+#include <rg/Mesh.h>
+#include <rg/VertexLayout.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace rg {
+
+//komanda za glMultiDrawElementsIndirect, raspored propisuje specifikacija
+struct DrawElementsIndirectCommand {
+    uint32_t m_count;
+    uint32_t m_instance_count;
+    uint32_t m_first_index;
+    int32_t m_base_vertex;
+    uint32_t m_base_instance;
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand mora biti bez dopune");
+
+//trajno mapiran bafer podeljen na FRAME_REGIONS delova: CPU pise deo tekuceg frejma dok GPU cita prethodne
+//zauzima se preko GL_COPY_WRITE_BUFFER da ne bi menjao vezivanja koja prati GlStateCache
+class PersistentBuffer {
+public:
+    static const unsigned int FRAME_REGIONS = 3;
+
+    PersistentBuffer() = default;
+    PersistentBuffer(const PersistentBuffer&) = delete;
+    PersistentBuffer& operator=(const PersistentBuffer&) = delete;
+
+    ~PersistentBuffer() {
+        release();
+    }
+
+    //stari bafer se brise odmah, GL ga oslobadja tek kad ga GPU vise ne koristi
+    bool allocate(size_t region_bytes) {
+        release();
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &m_buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+        glBufferStorage(GL_COPY_WRITE_BUFFER, region_bytes * FRAME_REGIONS, nullptr, flags);
+        m_data = static_cast<char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, region_bytes * FRAME_REGIONS, flags));
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        if (m_data == nullptr) {
+            std::cerr << "ERROR::INDIRECT::MAPIRANJE_BAFERA" << "\n";
+            release();
+            return false;
+        }
+        m_region_bytes = region_bytes;
+        return true;
+    }
+
+    void release() {
+        if (m_buffer != 0) {
+            glDeleteBuffers(1, &m_buffer);
+        }
+        m_buffer = 0;
+        m_data = nullptr;
+        m_region_bytes = 0;
+    }
+
+    unsigned int buffer() const {
+        return m_buffer;
+    }
+
+    size_t regionBytes() const {
+        return m_region_bytes;
+    }
+
+    //pocetak dela u mapiranoj memoriji i njegov pomeraj u baferu
+    char* region(unsigned int index) const {
+        return m_data + index * m_region_bytes;
+    }
+
+    size_t regionOffset(unsigned int index) const {
+        return index * m_region_bytes;
+    }
+
+private:
+    unsigned int m_buffer = 0;
+    char* m_data = nullptr;
+    size_t m_region_bytes = 0;
+};
+
+//GL 4.3+ put za RenderQueue: mesh-evi istog formata verteksa i sirine indeksa dele VAO i bafere GeometryPool-a,
+//pa se vise mesh-eva istog materijala crta jednim glMultiDrawElementsIndirect-om; komande i model matrice se pisu
+//u trajno mapirane bafere, a baseInstance komande pokazuje na njene matrice, koje object.vs sa INSTANCED
+//cita sa INSTANCE_MATRIX_LOCATION; atributi instance u zajednickom VAO-u se usmeravaju na bafer matrica pri
+//svakom crtanju, jer isti VAO koristi i GL 3.3 put sa svojim baferima instanci
+//komande se pisu jednom po frejmu, a crtaju po opsezima koliko god puta treba (npr. u prolazu samo dubine i u
+//prolazu osvetljenja); deo bafera se zatvara ogradom tek kad ga svi prolazi frejma iskoriste
+class MultiDrawIndirect {
+public:
+    MultiDrawIndirect() = default;
+    MultiDrawIndirect(const MultiDrawIndirect&) = delete;
+    MultiDrawIndirect& operator=(const MultiDrawIndirect&) = delete;
+
+    ~MultiDrawIndirect() {
+        release();
+    }
+
+    //brise sve GL objekte, pri gasenju dok kontekst jos postoji (kad objekat zivi duze od njega)
+    void release() {
+        for (GLsync& fence : m_fences) {
+            if (fence) {
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+        m_commands.release();
+        m_matrices.release();
+        m_region = 0;
+    }
+
+    //glMultiDrawElementsIndirect, baseInstance u komandi i trajno mapirani baferi (jezgro GL 4.4)
+    //proverava se posle inicijalizacije GLAD-a; bez podrske RenderQueue ostaje na GL 3.3 putu
+    static bool isSupported() {
+        return GLAD_GL_ARB_multi_draw_indirect && GLAD_GL_ARB_base_instance && GLAD_GL_ARB_buffer_storage &&
+               glMultiDrawElementsIndirect != nullptr && glBufferStorage != nullptr;
+    }
+
+    //ceka da GPU zavrsi deo bafera koji se sada pise i obezbedjuje mesto za najvise commands komandi
+    //i matrices matrica
+    bool beginFrame(size_t commands, size_t matrices) {
+        waitForRegion();
+        if (commands * sizeof(DrawElementsIndirectCommand) > m_commands.regionBytes() ||
+            matrices * sizeof(glm::mat4) > m_matrices.regionBytes()) {
+            //stari baferi se brisu, delovi koje GPU jos cita ostaju zivi do kraja tih komandi
+            for (GLsync& fence : m_fences) {
+                if (fence) {
+                    glDeleteSync(fence);
+                    fence = nullptr;
+                }
+            }
+            //najmanji kapacitet, u elementima po frejmu
+            const size_t MIN_CAPACITY = 1024;
+            size_t command_capacity = std::max<size_t>(commands, m_commands.regionBytes() / sizeof(DrawElementsIndirectCommand) * 2);
+            size_t matrix_capacity = std::max<size_t>(matrices, m_matrices.regionBytes() / sizeof(glm::mat4) * 2);
+            command_capacity = std::max<size_t>(command_capacity, MIN_CAPACITY);
+            matrix_capacity = std::max<size_t>(matrix_capacity, MIN_CAPACITY);
+            if (!m_commands.allocate(command_capacity * sizeof(DrawElementsIndirectCommand)) ||
+                !m_matrices.allocate(matrix_capacity * sizeof(glm::mat4))) {
+                m_commands.release();
+                m_matrices.release();
+                return false;
+            }
+        }
+
+        m_command_data = reinterpret_cast<DrawElementsIndirectCommand*>(m_commands.region(m_region));
+        m_matrix_data = reinterpret_cast<glm::mat4*>(m_matrices.region(m_region));
+        m_command_count = 0;
+        m_matrix_count = 0;
+        m_command_geometry.clear();
+        m_active = true;
+        return true;
+    }
+
+    //dodaje komandu na kraj dela frejma; count matrica (1 za pojedinacan objekat) se kopira u bafer frejma
+    void addCommand(const Mesh &mesh, unsigned int lod, const glm::mat4* matrices, unsigned int count) {
+        const MeshLod& range = mesh.LodRange(lod);
+        DrawElementsIndirectCommand& command = m_command_data[m_command_count++];
+        command.m_count = range.m_index_count;
+        command.m_instance_count = count;
+        command.m_first_index = mesh.FirstIndex(range);
+        command.m_base_vertex = (int32_t) mesh.BaseVertex();
+        command.m_base_instance = (uint32_t) (m_region * (m_matrices.regionBytes() / sizeof(glm::mat4)) + m_matrix_count);
+        std::memcpy(m_matrix_data + m_matrix_count, matrices, count * sizeof(glm::mat4));
+        m_matrix_count += count;
+        m_command_geometry.push_back({(size_t) range.m_index_count / 3 * count, (unsigned int) (&range - &mesh.m_lods[0])});
+    }
+
+    //broj komandi upisanih u ovom frejmu, ujedno indeks sledece
+    size_t commandCount() const {
+        return m_command_count;
+    }
+
+    //crta count komandi od komande first jednim pozivom; svi mesh-evi moraju deliti VAO i tip indeksa sa mesh
+    void draw(GlStateCache &state, const Mesh &mesh, size_t first, size_t count) {
+        if (count == 0)
+            return;
+
+        //matrice se citaju od pocetka bafera; deo frejma se bira preko baseInstance
+        state.bindVertexArray(mesh.VAO);
+        state.bindArrayBuffer(m_matrices.buffer());
+        for (unsigned int column = 0; column < 4; column++) {
+            unsigned int location = INSTANCE_MATRIX_LOCATION + column;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*) (column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(location, 1);
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commands.buffer());
+        size_t offset = m_commands.regionOffset(m_region) + first * sizeof(DrawElementsIndirectCommand);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, mesh.m_index_type, (void*) offset, (GLsizei) count, 0);
+        FrameStats::instance().recordMultiDraw(count);
+        for (size_t i = first; i < first + count; i++) {
+            FrameStats::instance().recordIndirectCommand(m_command_geometry[i].m_triangles, m_command_geometry[i].m_lod);
+        }
+    }
+
+    //ogradom oznacava kraj citanja dela ovog frejma i prelazi na sledeci
+    void endFrame() {
+        if (!m_active)
+            return;
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_region = (m_region + 1) % PersistentBuffer::FRAME_REGIONS;
+        m_active = false;
+    }
+
+private:
+    PersistentBuffer m_commands;
+    PersistentBuffer m_matrices;
+    GLsync m_fences[PersistentBuffer::FRAME_REGIONS] = {};
+    unsigned int m_region = 0;
+    bool m_active = false;
+
+    DrawElementsIndirectCommand* m_command_data = nullptr;
+    glm::mat4* m_matrix_data = nullptr;
+    size_t m_command_count = 0;
+    size_t m_matrix_count = 0;
+
+    //trouglovi i nivo detalja po komandi, za FrameStats pri svakom crtanju
+    struct CommandGeometry {
+        size_t m_triangles;
+        unsigned int m_lod;
+    };
+    std::vector<CommandGeometry> m_command_geometry;
+
+    //GPU dovoljno brzo odradi tri frejma, pa se ceka samo kad CPU stvarno prestigne GPU
+    void waitForRegion() {
+        GLsync& fence = m_fences[m_region];
+        if (!fence)
+            return;
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        while (result == GL_TIMEOUT_EXPIRED) {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        if (result == GL_WAIT_FAILED) {
+            std::cerr << "ERROR::INDIRECT::CEKANJE_OGRADE" << "\n";
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_MULTIDRAWINDIRECT_H
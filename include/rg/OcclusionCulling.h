@@ -0,0 +1,210 @@
+#ifndef PROJECT_BASE_OCCLUSIONCULLING_H
+#define PROJECT_BASE_OCCLUSIONCULLING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/Bounds.h>
+#include <rg/FrameStats.h>
+#include <rg/Shader.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rg {
+
+constexpr UniformName BOX_MIN_UNIFORM("boxMin");
+constexpr UniformName BOX_MAX_UNIFORM("boxMax");
+
+//odbacivanje zaklonjenih objekata upitima GL_ANY_SAMPLES_PASSED nad njihovim granicnim kvadrima
+//posle scene se kvadri objekata iz piramide pogleda crtaju bez upisa boje i dubine u isti (MSAA) framebuffer, pa upit
+//kaze da li bi ijedan uzorak kvadra prosao test dubine; rezultat se cita tek kad je dostupan, obicno u sledecem frejmu,
+//pa CPU nikad ne ceka GPU
+//dok upit nije gotov objekat se crta uslovno (glBeginConditionalRender sa GL_QUERY_NO_WAIT): GPU ga preskace ako je
+//upit do tada pokazao da je zaklonjen, a crta ga ako rezultat jos nije spreman
+//koristi se samo sa GL niti
+class OcclusionCulling {
+public:
+    //kamera ovoliko blizu kvadra vidi objekat bez upita, jer bi bliska ravan odsekla lica kvadra
+    float m_near_margin = 0.2f;
+
+    OcclusionCulling() = default;
+    OcclusionCulling(const OcclusionCulling&) = delete;
+    OcclusionCulling& operator=(const OcclusionCulling&) = delete;
+
+    ~OcclusionCulling() {
+        release();
+    }
+
+    void release() {
+        if (!m_queries.empty()) {
+            glDeleteQueries((GLsizei) m_queries.size(), m_queries.data());
+        }
+        m_queries.clear();
+        m_objects.clear();
+        if (m_vao != 0) {
+            glDeleteVertexArrays(1, &m_vao);
+            glDeleteBuffers(1, &m_vbo);
+            glDeleteBuffers(1, &m_ebo);
+        }
+        m_vao = 0;
+        m_vbo = 0;
+        m_ebo = 0;
+    }
+
+    //granice objekata u svetu, po jedan upit za svaki; svi su vidljivi dok ne stigne prvi rezultat
+    void setObjects(const std::vector<AABB>& bounds) {
+        if (!m_queries.empty()) {
+            glDeleteQueries((GLsizei) m_queries.size(), m_queries.data());
+        }
+        m_queries.assign(bounds.size(), 0);
+        if (!m_queries.empty()) {
+            glGenQueries((GLsizei) m_queries.size(), m_queries.data());
+        }
+        m_objects.assign(bounds.size(), Object());
+        for (size_t i = 0; i < bounds.size(); i++) {
+            m_objects[i].m_bounds = bounds[i];
+        }
+    }
+
+    size_t size() const {
+        return m_objects.size();
+    }
+
+    //preuzima rezultate gotovih upita, bez cekanja; poziva se pre slanja scene
+    //objekat van piramide pogleda postaje vidljiv, a rezultat upita postavljenog pre izlaska se zanemaruje,
+    //da objekat ne bi ostao sakriven po zastarelom rezultatu kad se vrati u pogled
+    void collect(const std::vector<uint8_t>& in_frustum) {
+        for (size_t i = 0; i < m_objects.size(); i++) {
+            Object& object = m_objects[i];
+            if (object.m_pending) {
+                GLuint available = 0;
+                glGetQueryObjectuiv(m_queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+                if (available) {
+                    GLuint passed = 0;
+                    glGetQueryObjectuiv(m_queries[i], GL_QUERY_RESULT, &passed);
+                    if (!object.m_stale) {
+                        object.m_visible = passed != 0;
+                    }
+                    object.m_pending = false;
+                    object.m_stale = false;
+                }
+            }
+            if (!in_frustum[i]) {
+                object.m_visible = true;
+                object.m_stale = object.m_pending;
+            }
+        }
+    }
+
+    //upit za uslovno crtanje objekta dok mu rezultat nije stigao; 0 ako je odluka vec poznata na CPU-u
+    unsigned int condition(size_t object) const {
+        return m_objects[object].m_pending && !m_objects[object].m_stale ? m_queries[object] : 0;
+    }
+
+    //objekat se salje ako ga poslednji rezultat nije proglasio zaklonjenim ili ako o njemu odlucuje GPU
+    bool shouldDraw(size_t object) const {
+        return m_objects[object].m_visible || condition(object) != 0;
+    }
+
+    //postavlja upite za objekte iz piramide pogleda ciji prethodni upit nije u toku; poziva se posle scene, dok je
+    //vezan njen framebuffer sa dubinom; posle crtanja vraca podrazumevano stanje (upis boje i dubine, GL_LESS,
+    //odsecanje zadnjih lica) i belezi zaklonjene objekte frejma u FrameStats
+    void issue(Shader& shader, const std::vector<uint8_t>& in_frustum, const glm::vec3& camera_position) {
+        if (m_objects.empty())
+            return;
+        createBox();
+
+        size_t queries = 0;
+        size_t occluded = 0;
+        size_t conditional = 0;
+        shader.use();
+        glBindVertexArray(m_vao);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        //lice kvadra koje se poklapa sa povrsinom objekta (npr. ravno tlo) prolazi test
+        glDepthFunc(GL_LEQUAL);
+        glDisable(GL_CULL_FACE);
+        for (size_t i = 0; i < m_objects.size(); i++) {
+            Object& object = m_objects[i];
+            if (!in_frustum[i])
+                continue;
+            occluded += shouldDraw(i) ? 0 : 1;
+            conditional += condition(i) != 0 ? 1 : 0;
+            if (object.m_pending)
+                continue;
+
+            glm::vec3 margin(m_near_margin);
+            glm::vec3 box_min = object.m_bounds.m_min - margin;
+            glm::vec3 box_max = object.m_bounds.m_max + margin;
+            if (camera_position.x >= box_min.x && camera_position.y >= box_min.y && camera_position.z >= box_min.z &&
+                camera_position.x <= box_max.x && camera_position.y <= box_max.y && camera_position.z <= box_max.z) {
+                object.m_visible = true;
+                continue;
+            }
+
+            shader.setVec3(BOX_MIN_UNIFORM, object.m_bounds.m_min);
+            shader.setVec3(BOX_MAX_UNIFORM, object.m_bounds.m_max);
+            glBeginQuery(GL_ANY_SAMPLES_PASSED, m_queries[i]);
+            glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, (void*) 0);
+            glEndQuery(GL_ANY_SAMPLES_PASSED);
+            object.m_pending = true;
+            queries++;
+        }
+        glEnable(GL_CULL_FACE);
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glBindVertexArray(0);
+        FrameStats::instance().recordOcclusion(queries, occluded, conditional);
+    }
+
+private:
+    struct Object {
+        AABB m_bounds;
+        bool m_visible = true;
+        bool m_pending = false; // upit je postavljen, rezultat jos nije procitan
+        bool m_stale = false;   // upit je postavljen pre izlaska iz piramide pogleda
+    };
+
+    std::vector<Object> m_objects;
+    std::vector<GLuint> m_queries;
+    unsigned int m_vao = 0;
+    unsigned int m_vbo = 0;
+    unsigned int m_ebo = 0;
+
+    //jedinicna kocka [0, 1]^3; shader je razvlaci od boxMin do boxMax
+    void createBox() {
+        if (m_vao != 0)
+            return;
+        const float vertices[] = {
+                0.0f, 0.0f, 0.0f,  1.0f, 0.0f, 0.0f,  1.0f, 1.0f, 0.0f,  0.0f, 1.0f, 0.0f,
+                0.0f, 0.0f, 1.0f,  1.0f, 0.0f, 1.0f,  1.0f, 1.0f, 1.0f,  0.0f, 1.0f, 1.0f
+        };
+        const uint8_t indices[] = {
+                0, 2, 1,  0, 3, 2,
+                4, 5, 6,  4, 6, 7,
+                0, 1, 5,  0, 5, 4,
+                3, 6, 2,  3, 7, 6,
+                0, 4, 7,  0, 7, 3,
+                1, 2, 6,  1, 6, 5
+        };
+        glGenVertexArrays(1, &m_vao);
+        glGenBuffers(1, &m_vbo);
+        glGenBuffers(1, &m_ebo);
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*) 0);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_OCCLUSIONCULLING_H
@@ -0,0 +1,134 @@
+#ifndef PROJECT_BASE_PASSQUERIES_H
+#define PROJECT_BASE_PASSQUERIES_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace rg {
+
+//rezultat upita po prolazu frejma: GPU vreme (GL_TIME_ELAPSED) ili broj uzoraka koji su prosli test dubine
+//(GL_SAMPLES_PASSED; u MSAA framebuffer-u broji uzorke, ne piksele)
+//svaki prolaz ima FRAME_LATENCY upita u krug; rezultat se cita tek kad se upit ponovo koristi, posle FRAME_LATENCY
+//frejmova, kada je GPU vec gotov, pa citanje ne zaustavlja CPU
+//prolazi jednog objekta se ne smeju preklapati (GL dozvoljava jedan aktivan upit po vrsti), prolazi dva objekta
+//razlicitih vrsta smeju; koristi se samo sa GL niti
+class PassQueries {
+public:
+    static const unsigned int FRAME_LATENCY = 3;
+
+    explicit PassQueries(GLenum target) : m_target(target) {}
+
+    PassQueries(const PassQueries&) = delete;
+    PassQueries& operator=(const PassQueries&) = delete;
+
+    ~PassQueries() {
+        release();
+    }
+
+    void release() {
+        for (Pass& pass : m_passes) {
+            glDeleteQueries(FRAME_LATENCY, pass.m_queries);
+            for (unsigned int i = 0; i < FRAME_LATENCY; i++) {
+                pass.m_queries[i] = 0;
+                pass.m_pending[i] = false;
+            }
+        }
+        m_passes.clear();
+    }
+
+    void begin(const char* name) {
+        Pass& pass = find(name);
+        unsigned int slot = m_frame % FRAME_LATENCY;
+        if (pass.m_pending[slot]) {
+            collect(pass, slot);
+        }
+        glBeginQuery(m_target, pass.m_queries[slot]);
+        pass.m_pending[slot] = true;
+    }
+
+    void end() {
+        glEndQuery(m_target);
+    }
+
+    //zatvara frejm; jednom u intervalu ispisuje prosek svakog prolaza koji je meren u tom intervalu
+    void endFrame(double time, std::ostream& out = std::cout) {
+        m_frame++;
+        if (m_interval_start < 0.0) {
+            m_interval_start = time;
+        }
+        if (time - m_interval_start < m_report_interval) {
+            return;
+        }
+
+        bool first = true;
+        for (Pass& pass : m_passes) {
+            if (pass.m_samples == 0)
+                continue;
+            bool time = m_target == GL_TIME_ELAPSED;
+            out << (first ? (time ? "GPU po frejmu: " : "Uzorci po frejmu: ") : ", ") << pass.m_name << " ";
+            if (time) {
+                out << pass.m_total / pass.m_samples / 1000000.0 << " ms";
+            } else {
+                out << (uint64_t) (pass.m_total / pass.m_samples);
+            }
+            first = false;
+            pass.m_total = 0.0;
+            pass.m_samples = 0;
+        }
+        if (!first) {
+            out << "\n";
+        }
+        m_interval_start = time;
+    }
+
+    double m_report_interval = 1.0;
+
+private:
+    struct Pass {
+        std::string m_name;
+        unsigned int m_queries[FRAME_LATENCY];
+        bool m_pending[FRAME_LATENCY];
+        double m_total; // zbir rezultata, nanosekunde ili uzorci
+        size_t m_samples;
+    };
+
+    GLenum m_target;
+    std::vector<Pass> m_passes;
+    size_t m_frame = 0;
+    double m_interval_start = -1.0;
+
+    //prolaza je malo, pa je linearna pretraga po imenu dovoljna
+    Pass& find(const char* name) {
+        for (Pass& pass : m_passes) {
+            if (pass.m_name == name)
+                return pass;
+        }
+        Pass pass;
+        pass.m_name = name;
+        glGenQueries(FRAME_LATENCY, pass.m_queries);
+        for (bool& pending : pass.m_pending) {
+            pending = false;
+        }
+        pass.m_total = 0.0;
+        pass.m_samples = 0;
+        m_passes.push_back(pass);
+        return m_passes.back();
+    }
+
+    void collect(Pass& pass, unsigned int slot) {
+        GLuint64 result = 0;
+        glGetQueryObjectui64v(pass.m_queries[slot], GL_QUERY_RESULT, &result);
+        pass.m_total += (double) result;
+        pass.m_samples++;
+        pass.m_pending[slot] = false;
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_PASSQUERIES_H
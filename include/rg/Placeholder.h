@@ -0,0 +1,81 @@
+#ifndef PROJECT_BASE_PLACEHOLDER_H
+#define PROJECT_BASE_PLACEHOLDER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/Bounds.h>
+#include <rg/Mesh.h>
+
+namespace rg {
+
+//1x1 siva tekstura kojom se boje placeholder-i dok se pravi model ne ucita
+inline unsigned int placeholderTexture() {
+    static unsigned int textureID = 0;
+    if (textureID == 0) {
+        const unsigned char grey[4] = {128, 128, 128, 255};
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    return textureID;
+}
+
+//kvadar jednobojne boje preko granica mesh-a, crta se istim shader-om kao i pravi model
+inline MeshData placeholderBox(const AABB& bounds) {
+    MeshData data;
+    data.m_bounds = bounds;
+    data.m_sphere.m_center = bounds.center();
+    data.m_sphere.m_radius = glm::length(bounds.extents());
+
+    glm::vec3 center = bounds.center();
+    glm::vec3 extents = bounds.extents();
+
+    for (int axis = 0; axis < 3; axis++) {
+        for (int sign = -1; sign <= 1; sign += 2) {
+            //u i v su izabrani tako da je u x v = normala, pa su stranice CCW gledano spolja
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = (float) sign;
+            u[(axis + 1) % 3] = extents[(axis + 1) % 3];
+            v[(axis + 2) % 3] = extents[(axis + 2) % 3];
+            if (sign < 0) {
+                glm::vec3 tmp = u;
+                u = v;
+                v = tmp;
+            }
+
+            glm::vec3 face_center = center + normal * extents[axis];
+            const glm::vec2 corners[4] = {glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f),
+                                          glm::vec2(1.0f, 1.0f), glm::vec2(-1.0f, 1.0f)};
+
+            unsigned int first = (unsigned int) data.m_vertices.size();
+            for (const glm::vec2& corner : corners) {
+                Vertex vertex{};
+                vertex.m_position = face_center + u * corner.x + v * corner.y;
+                vertex.m_normal = normal;
+                vertex.m_texture_coordinates = corner * 0.5f + 0.5f;
+                data.m_vertices.push_back(vertex);
+            }
+
+            const unsigned int quad[6] = {0, 1, 2, 0, 2, 3};
+            for (unsigned int index : quad) {
+                data.m_indices.push_back(first + index);
+            }
+        }
+    }
+
+    Texture texture;
+    texture.m_id = placeholderTexture();
+    texture.m_type = "texture_diffuse";
+    data.m_textures.push_back(texture);
+    texture.m_type = "texture_specular";
+    data.m_textures.push_back(texture);
+
+    return data;
+}
+
+}
+
+#endif //PROJECT_BASE_PLACEHOLDER_H
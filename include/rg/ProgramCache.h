@@ -0,0 +1,147 @@
+#ifndef PROJECT_BASE_PROGRAMCACHE_H
+#define PROJECT_BASE_PROGRAMCACHE_H
+
+#include <glad/glad.h>
+
+#include <rg/Hash.h>
+#include <rg/MappedFile.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace rg {
+
+//binarni kes povezanih programa (glGetProgramBinary), zaobilazi kompajliranje GLSL-a pri sledecem pokretanju
+//format: ProgramCacheHeader pa binarni program u formatu drajvera
+//binarni program vazi samo za isti drajver i isti GPU, pa se uz hes izvornog koda cuva i hes opisa drajvera
+const uint32_t PROGRAM_CACHE_MAGIC = 0x50434752; // "RGCP"
+const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+struct ProgramCacheHeader {
+    uint32_t m_magic;
+    uint32_t m_version;
+    uint64_t m_source_hash;
+    uint64_t m_driver_hash;
+    uint32_t m_binary_format;
+    uint32_t m_binary_size;
+};
+
+class ProgramCache {
+public:
+    //prosirenje postoji, a drajver nudi bar jedan binarni format (neki ga prijave bez ijednog formata)
+    static bool isSupported() {
+        if (!GLAD_GL_ARB_get_program_binary || glGetProgramBinary == nullptr || glProgramBinary == nullptr)
+            return false;
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+
+    //proizvodjac, GPU i verzija drajvera; nova verzija drajvera ponistava sve kesirane programe
+    static uint64_t driverHash() {
+        uint64_t hash = FNV1A64_OFFSET;
+        for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+            const char* value = reinterpret_cast<const char*>(glGetString(name));
+            hash = hashString(value ? value : "", hash);
+            hash = hashFnv1a64("\n", 1, hash);
+        }
+        return hash;
+    }
+
+    //fajl kesa stoji pored fragment shader-a; ime zavisi od para shader-a i define-ova, ne od sadrzaja,
+    //pa izmena izvornog koda prepisuje isti fajl umesto da ostavlja stare
+    static std::string path(const std::string& vertex_path, const std::string& fragment_path, const std::string& defines) {
+        uint64_t hash = hashString(vertex_path.c_str());
+        hash = hashString(defines.c_str(), hash);
+        char name[17];
+        std::snprintf(name, sizeof(name), "%016llx", (unsigned long long) hash);
+        return fragment_path + "." + name + ".programcache";
+    }
+
+    //ucitava binarni program u program, vraca false ako kes ne postoji, zastareo je ili ga drajver odbije
+    //zastareo ili odbijen kes se brise, pa se program kompajlira iz izvornog koda i kes upisuje ponovo
+    static bool load(unsigned int program, const std::string& cache_path, uint64_t source_hash) {
+        bool stale = false;
+        {
+            MappedFile file(cache_path);
+            if (!file.isOpen()) {
+                return false;
+            }
+
+            ProgramCacheHeader header;
+            if (file.size() < sizeof(header)) {
+                stale = true;
+            } else {
+                std::memcpy(&header, file.data(), sizeof(header));
+                //invalidacija: drugi format kesa, drugi izvorni kod ili define-ovi, drugi drajver
+                stale = header.m_magic != PROGRAM_CACHE_MAGIC || header.m_version != PROGRAM_CACHE_VERSION ||
+                        header.m_source_hash != source_hash || header.m_driver_hash != driverHash() ||
+                        file.size() - sizeof(header) < header.m_binary_size;
+            }
+
+            if (!stale) {
+                glProgramBinary(program, header.m_binary_format, file.data() + sizeof(header), (GLsizei) header.m_binary_size);
+                GLint status = GL_FALSE;
+                glGetProgramiv(program, GL_LINK_STATUS, &status);
+                stale = status != GL_TRUE;
+            }
+        }
+
+        if (stale) {
+            std::remove(cache_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    //upisuje binarni program u privremeni fajl pa ga preimenuje, da prekinut upis ne bi ostavio pokvaren kes
+    //program mora biti povezan sa GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    static bool store(unsigned int program, const std::string& cache_path, uint64_t source_hash) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) {
+            return false;
+        }
+
+        std::vector<char> binary((size_t) length);
+        GLenum format = 0;
+        GLsizei written = 0;
+        glGetProgramBinary(program, length, &written, &format, binary.data());
+        if (written <= 0) {
+            return false;
+        }
+
+        ProgramCacheHeader header;
+        header.m_magic = PROGRAM_CACHE_MAGIC;
+        header.m_version = PROGRAM_CACHE_VERSION;
+        header.m_source_hash = source_hash;
+        header.m_driver_hash = driverHash();
+        header.m_binary_format = format;
+        header.m_binary_size = (uint32_t) written;
+
+        std::string temporary_path = cache_path + ".tmp";
+        std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "ERROR::PROGRAM_CACHE::NEUSPESNO_PISANJE " << cache_path << "\n";
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(binary.data(), written);
+        out.close();
+        if (!out || std::rename(temporary_path.c_str(), cache_path.c_str()) != 0) {
+            std::cerr << "ERROR::PROGRAM_CACHE::NEUSPESNO_PISANJE " << cache_path << "\n";
+            std::remove(temporary_path.c_str());
+            return false;
+        }
+        return true;
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_PROGRAMCACHE_H
@@ -0,0 +1,337 @@
+#ifndef PROJECT_BASE_RENDERQUEUE_H
+#define PROJECT_BASE_RENDERQUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/FrameStats.h>
+#include <rg/GlStateCache.h>
+#include <rg/Mesh.h>
+#include <rg/MultiDrawIndirect.h>
+#include <rg/Shader.h>
+#include <rg/ShaderVariants.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rg {
+
+//neprovidni objekti se crtaju pre providnih
+enum class RenderPass : uint8_t {
+    Opaque = 0,
+    Transparent = 1
+};
+
+//64-bitni kljuc za sortiranje, od najviseg bita:
+//neprovidni:  prolaz 2 | shader 8 | materijal 16 | VAO 14 | dubina 24 (od blizeg ka daljem)
+//providni:    prolaz 2 | dubina 24 (od daljeg ka blizem) | shader 8 | materijal 16 | VAO 14
+//id-jevi se seku na broj bitova, sudar samo pogorsava grupisanje jer se stanje poredi po pravim vrednostima
+inline uint64_t makeSortKey(RenderPass pass, unsigned int shader, unsigned int material, unsigned int vertex_array,
+                            float depth) {
+    const uint64_t DEPTH_MAX = (1u << 24) - 1;
+    uint64_t quantized = (uint64_t) (std::min(std::max(depth, 0.0f), 1.0f) * DEPTH_MAX);
+    uint64_t state = ((uint64_t) (shader & 0xFF) << 30) | ((uint64_t) (material & 0xFFFF) << 14) | (vertex_array & 0x3FFF);
+    if (pass == RenderPass::Opaque) {
+        return ((uint64_t) pass << 62) | (state << 24) | quantized;
+    }
+    return ((uint64_t) pass << 62) | ((DEPTH_MAX - quantized) << 38) | state;
+}
+
+//jedan poziv crtanja: mesh na nivou detalja sa model matricom ili opseg matrica u baferu instanci
+struct DrawPacket {
+    Shader *m_shader;
+    //ako nije nullptr, shader se pri svakom submit-u bira iz kesa varijanti po m_features; m_shader je varijanta
+    //iz koje je izracunat kljuc
+    ShaderVariants *m_variants;
+    uint32_t m_features;
+    Mesh *m_mesh;
+    unsigned int m_lod;
+    unsigned int m_material;
+    glm::mat4 m_model;
+
+    //instanciran poziv ako je m_instance_count > 0
+    unsigned int m_instance_buffer;
+    size_t m_instance_offset;
+    unsigned int m_instance_count;
+
+    //CPU kopija matrica iz bafera instanci, vazi do sledeceg begin-a; bez nje paket ne ide indirektnim putem
+    const glm::mat4* m_instance_matrices;
+
+    //upit zaklonjenosti za uslovno crtanje, 0 za bezuslovno
+    unsigned int m_condition;
+};
+
+//skuplja pozive crtanja jednog frejma, sortira ih po kljucu i salje bez ponovljenih vezivanja stanja
+//bez sortiranja (m_sorting = false) poziva redom kojim su dodati i vezuje sve za svaki poziv, radi poredjenja
+//sa indirektnim putem (GL 4.3+) uzastopni paketi istog programa i materijala idu jednim glMultiDrawElementsIndirect-om;
+//tim putem ide paket ciji program nema "model" uniform, vec model matricu cita iz atributa instance
+//paketi sa upitom zaklonjenosti (setCondition) se crtaju izmedju glBeginConditionalRender i glEndConditionalRender;
+//u indirektnu grupu ulaze samo paketi istog upita
+//paketi vaze od begin do sledeceg begin-a, pa se isti frejm moze poslati vise puta (npr. prolaz samo dubine pa prolaz
+//osvetljenja): sortiranje i upis indirektnih komandi se rade pri prvom submit-u, a ostali ih samo ponovo crtaju
+class RenderQueue {
+public:
+    bool m_sorting = true;
+
+    //indirektni put kad ga drajver podrzava; inace, ili kad je iskljucen, crta se pojedinacnim pozivima
+    bool m_indirect = true;
+
+    //rastojanje koje se preslikava na najvecu dubinu u kljucu, obicno daljina kamere
+    float m_depth_range = 100.0f;
+
+    void begin(const glm::vec3& camera_position) {
+        //komande prethodnog frejma citaju svi njegovi prolazi, pa se njihov deo bafera zatvara ogradom tek sada
+        m_multi_draw.endFrame();
+        m_camera_position = camera_position;
+        m_packets.clear();
+        m_keys.clear();
+        m_condition = 0;
+        m_prepared = false;
+    }
+
+    //paketi dodati posle poziva crtaju se samo ako je upit query (GL_ANY_SAMPLES_PASSED) nasao vidljive uzorke,
+    //ili ako njegov rezultat jos nije spreman (GL_QUERY_NO_WAIT); 0 vraca bezuslovno crtanje
+    void setCondition(unsigned int query) {
+        m_condition = query;
+    }
+
+    //center je centar objekta u svetu, za redosled po dubini
+    void push(Shader &shader, Mesh &mesh, unsigned int lod, const glm::mat4& model, const glm::vec3& center,
+              RenderPass pass = RenderPass::Opaque) {
+        add(shader, nullptr, 0, mesh, lod, model, 0, 0, 0, nullptr, center, pass);
+    }
+
+    //shader je varijanta iz variants sa osobinama features, birana pri svakom submit-u
+    void push(ShaderVariants &variants, uint32_t features, Mesh &mesh, unsigned int lod, const glm::mat4& model,
+              const glm::vec3& center, RenderPass pass = RenderPass::Opaque) {
+        add(variants.get(features), &variants, features, mesh, lod, model, 0, 0, 0, nullptr, center, pass);
+    }
+
+    //matrices su iste matrice koje su poslate u instance_buffer od bajta offset, nullptr ako CPU kopija ne postoji
+    void pushInstanced(Shader &shader, Mesh &mesh, unsigned int lod, unsigned int instance_buffer, size_t offset,
+                       unsigned int count, const glm::mat4* matrices, const glm::vec3& center,
+                       RenderPass pass = RenderPass::Opaque) {
+        if (count == 0)
+            return;
+        add(shader, nullptr, 0, mesh, lod, glm::mat4(1.0f), instance_buffer, offset, count, matrices, center, pass);
+    }
+
+    void pushInstanced(ShaderVariants &variants, uint32_t features, Mesh &mesh, unsigned int lod,
+                       unsigned int instance_buffer, size_t offset, unsigned int count, const glm::mat4* matrices,
+                       const glm::vec3& center, RenderPass pass = RenderPass::Opaque) {
+        if (count == 0)
+            return;
+        add(variants.get(features), &variants, features, mesh, lod, glm::mat4(1.0f), instance_buffer, offset, count,
+            matrices, center, pass);
+    }
+
+    size_t size() const {
+        return m_packets.size();
+    }
+
+    //da li ce prvi submit frejma koristiti indirektni put; proverava se posle inicijalizacije GLAD-a
+    bool indirectActive() const {
+        return m_indirect && MultiDrawIndirect::isSupported();
+    }
+
+    const glm::vec3& cameraPosition() const {
+        return m_camera_position;
+    }
+
+    //paketi dodati preko kesa varijanti crtaju se varijantom iz variants sa istim osobinama, ako je zadat;
+    //paketi sa zadatim shader-om se uvek crtaju njime
+    void submit(ShaderVariants *variants = nullptr) {
+        //geometrija i baferi indirektnog puta se pripremaju pre crtanja, jer menjaju vezivanja mimo kesa stanja
+        if (!m_prepared) {
+            if (m_sorting) {
+                std::sort(m_keys.begin(), m_keys.end());
+            }
+            m_indirect_ready = indirectActive() && prepareIndirect();
+            m_prepared = true;
+        }
+
+        //program svakog paketa u ovom prolazu; indirektno se crta samo ako program model matricu cita iz atributa
+        m_pass_shaders.resize(m_packets.size());
+        m_pass_indirect.assign(m_packets.size(), 0);
+        for (size_t i = 0; i < m_packets.size(); i++) {
+            const DrawPacket& packet = m_packets[i];
+            m_pass_shaders[i] = packet.m_variants == nullptr ? packet.m_shader
+                                                              : &(variants ? variants : packet.m_variants)->get(packet.m_features);
+            m_pass_indirect[i] = m_indirect_ready && m_indirect_packets[i] && m_pass_shaders[i]->location(MODEL_UNIFORM) < 0;
+        }
+
+        m_state.reset();
+        m_state.resetCounters();
+        unsigned int material = 0;
+        Uniform<glm::mat4> model_uniform;
+        for (size_t i = 0; i < m_keys.size(); i++) {
+            uint32_t index = m_keys[i].second;
+            const DrawPacket& packet = m_packets[index];
+            Shader& shader = *m_pass_shaders[index];
+            if (!m_sorting) {
+                m_state.reset();
+            }
+
+            //vrednosti sampler uniform-a pripadaju programu, pa se materijal ponovo postavlja i posle promene shader-a
+            bool program_changed = m_state.useProgram(shader.m_id);
+            if (program_changed) {
+                model_uniform = shader.uniform<glm::mat4>(MODEL_UNIFORM);
+            }
+            if (program_changed || packet.m_material != material || !m_sorting) {
+                packet.m_mesh->BindMaterial(shader, m_state);
+                material = packet.m_material;
+            }
+
+            if (packet.m_condition != 0) {
+                glBeginConditionalRender(packet.m_condition, GL_QUERY_NO_WAIT);
+            }
+
+            //niz uzastopnih paketa istog programa, materijala, VAO-a, tipa indeksa i upita postaje jedan poziv;
+            //njihove komande su upisane istim redom, pa cine neprekinut opseg
+            if (m_pass_indirect[index]) {
+                const Mesh& mesh = *packet.m_mesh;
+                size_t end = i;
+                while (end < m_keys.size()) {
+                    uint32_t next_index = m_keys[end].second;
+                    const DrawPacket& next = m_packets[next_index];
+                    if (!m_pass_indirect[next_index] || m_pass_shaders[next_index] != &shader ||
+                        next.m_material != packet.m_material || next.m_mesh->VAO != mesh.VAO ||
+                        next.m_mesh->m_index_type != mesh.m_index_type || next.m_condition != packet.m_condition)
+                        break;
+                    end++;
+                }
+                m_multi_draw.draw(m_state, mesh, m_packet_commands[index], end - i);
+                if (packet.m_condition != 0) {
+                    glEndConditionalRender();
+                }
+                i = end - 1;
+                continue;
+            }
+
+            m_state.bindVertexArray(packet.m_mesh->VAO);
+            if (packet.m_instance_count > 0) {
+                packet.m_mesh->DrawBoundInstanced(m_state, packet.m_instance_buffer, packet.m_instance_offset,
+                                                  packet.m_instance_count, packet.m_lod);
+            } else if (model_uniform.isValid()) {
+                shader.set(model_uniform, packet.m_model);
+                packet.m_mesh->DrawBound(packet.m_lod);
+            } else {
+                //varijanta za indirektni put u frejmu koji nije mogao indirektno (npr. bafer nije mapiran):
+                //model matrica ide kao konstantna vrednost atributa instance, bez niza iz bafera
+                for (unsigned int column = 0; column < 4; column++) {
+                    glDisableVertexAttribArray(INSTANCE_MATRIX_LOCATION + column);
+                    glVertexAttrib4fv(INSTANCE_MATRIX_LOCATION + column, &packet.m_model[column][0]);
+                }
+                packet.m_mesh->DrawBound(packet.m_lod);
+            }
+            if (packet.m_condition != 0) {
+                glEndConditionalRender();
+            }
+        }
+
+        //ostatak frejma vezuje stanje direktno i ocekuje podrazumevane vrednosti
+        if (m_indirect_ready) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+        FrameStats::instance().recordStateChanges(m_state.changes(), m_state.skipped());
+    }
+
+    //GL objekti indirektnog puta; red koji zivi duze od konteksta ih oslobadja pre glfwTerminate
+    void release() {
+        m_multi_draw.release();
+    }
+
+    //id materijala po skupu tekstura i prefiksu imena u shader-u, dodeljuje se jednom po mesh-u
+    static unsigned int materialId(Mesh &mesh) {
+        if (mesh.m_material_id != 0)
+            return mesh.m_material_id;
+
+        static std::unordered_map<std::string, unsigned int> materials;
+        std::string signature = mesh.m_glslIdentifierPrefix;
+        for (const Texture& texture : mesh.m_textures) {
+            signature += "|" + texture.m_type + ":" + std::to_string(texture.m_id);
+        }
+        auto it = materials.find(signature);
+        if (it == materials.end()) {
+            it = materials.emplace(signature, (unsigned int) materials.size() + 1).first;
+        }
+        mesh.m_material_id = it->second;
+        return mesh.m_material_id;
+    }
+
+private:
+    glm::vec3 m_camera_position = glm::vec3(0.0f);
+    unsigned int m_condition = 0;
+    std::vector<DrawPacket> m_packets;
+
+    //sortiraju se parovi (kljuc, indeks paketa), ne ceo paket sa matricom
+    std::vector<std::pair<uint64_t, uint32_t>> m_keys;
+    GlStateCache m_state;
+
+    //paketi su sortirani i komande upisane za ovaj frejm
+    bool m_prepared = false;
+    bool m_indirect_ready = false;
+
+    MultiDrawIndirect m_multi_draw;
+    //po paketu: da li ima indirektnu komandu i njen indeks u delu frejma
+    std::vector<uint8_t> m_indirect_packets;
+    std::vector<uint32_t> m_packet_commands;
+
+    //po paketu, za tekuci prolaz: program i da li se crta indirektno
+    std::vector<Shader*> m_pass_shaders;
+    std::vector<uint8_t> m_pass_indirect;
+
+    //bira pakete za indirektni put i upisuje njihove komande redom kljuceva, jednom po frejmu
+    //false ako baferi nisu mogli da se zauzmu, pa se ceo frejm crta pojedinacnim pozivima
+    bool prepareIndirect() {
+        m_indirect_packets.assign(m_packets.size(), 0);
+        m_packet_commands.assign(m_packets.size(), 0);
+        size_t commands = 0;
+        size_t matrices = 0;
+        for (size_t i = 0; i < m_packets.size(); i++) {
+            const DrawPacket& packet = m_packets[i];
+            if (packet.m_shader->location(MODEL_UNIFORM) >= 0)
+                continue;
+            if (packet.m_instance_count > 0 && packet.m_instance_matrices == nullptr)
+                continue;
+            m_indirect_packets[i] = 1;
+            commands++;
+            matrices += std::max(packet.m_instance_count, 1u);
+        }
+        if (!m_multi_draw.beginFrame(commands, matrices))
+            return false;
+
+        for (const auto& key : m_keys) {
+            const DrawPacket& packet = m_packets[key.second];
+            if (!m_indirect_packets[key.second])
+                continue;
+            m_packet_commands[key.second] = (uint32_t) m_multi_draw.commandCount();
+            if (packet.m_instance_count > 0) {
+                m_multi_draw.addCommand(*packet.m_mesh, packet.m_lod, packet.m_instance_matrices, packet.m_instance_count);
+            } else {
+                m_multi_draw.addCommand(*packet.m_mesh, packet.m_lod, &packet.m_model, 1);
+            }
+        }
+        return true;
+    }
+
+    void add(Shader &shader, ShaderVariants *variants, uint32_t features, Mesh &mesh, unsigned int lod, const glm::mat4& model, unsigned int instance_buffer,
+             size_t offset, unsigned int count, const glm::mat4* matrices, const glm::vec3& center, RenderPass pass) {
+        unsigned int material = materialId(mesh);
+        float depth = glm::length(center - m_camera_position) / m_depth_range;
+        uint64_t key = makeSortKey(pass, shader.m_id, material, mesh.VAO, depth);
+        m_keys.push_back({key, (uint32_t) m_packets.size()});
+        m_packets.push_back({&shader, variants, features, &mesh, lod, material, model, instance_buffer, offset, count,
+                             matrices, m_condition});
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_RENDERQUEUE_H
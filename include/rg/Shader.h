@@ -4,144 +4,388 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <rg/Hash.h>
+#include <rg/ProgramCache.h>
+#include <rg/ShaderPreprocessor.h>
+#include <rg/UniformBuffer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
 #include <common.h>
 
+namespace rg {
+
+//ime uniform-a i njegov hes; constexpr UniformName NAME("ime") hesira ime pri kompajliranju
+struct UniformName {
+    uint64_t m_hash;
+    const char* m_name;
+
+    constexpr UniformName(const char* name) : m_hash(hashString(name)), m_name(name) {}
+
+    UniformName(const std::string& name) : m_hash(hashString(name.c_str())), m_name(nullptr) {}
+};
+
+//lokacija uniform-a tipa T, razresava se jednom preko Shader::uniform<T> i vazi dok program postoji
+//-1 (uniform ne postoji ili ga je kompajler izbacio) GL tiho ignorise
+template <typename T>
+struct Uniform {
+    int m_location = -1;
+
+    bool isValid() const {
+        return m_location >= 0;
+    }
+};
+
+//GL tip koji odgovara tipu handle-a, za proveru pri razresavanju
+template <typename T> struct UniformType;
+template <> struct UniformType<int> { static constexpr GLenum value = GL_INT; };
+template <> struct UniformType<unsigned int> { static constexpr GLenum value = GL_UNSIGNED_INT; };
+template <> struct UniformType<float> { static constexpr GLenum value = GL_FLOAT; };
+template <> struct UniformType<glm::vec2> { static constexpr GLenum value = GL_FLOAT_VEC2; };
+template <> struct UniformType<glm::vec3> { static constexpr GLenum value = GL_FLOAT_VEC3; };
+template <> struct UniformType<glm::vec4> { static constexpr GLenum value = GL_FLOAT_VEC4; };
+template <> struct UniformType<glm::mat2> { static constexpr GLenum value = GL_FLOAT_MAT2; };
+template <> struct UniformType<glm::mat3> { static constexpr GLenum value = GL_FLOAT_MAT3; };
+template <> struct UniformType<glm::mat4> { static constexpr GLenum value = GL_FLOAT_MAT4; };
+
+//model matrica koju Model i RenderQueue postavljaju za svaki objekat
+constexpr UniformName MODEL_UNIFORM("model");
+
+}
+
 class Shader {
 public:
     unsigned int m_id;
 
-    //konstruktor
-    Shader (const char* vertex_path, const char* fragment_path) {
+    //true ako je program ucitan iz binarnog kesa, a ne kompajliran iz izvornog koda
+    bool m_from_cache = false;
+    //vreme kompajliranja i povezivanja, odnosno ucitavanja iz kesa
+    float m_load_ms = 0.0f;
+
+    //konstruktor; define-ovi ("IME" ili "IME VREDNOST") se umecu posle #version linije oba shader-a
+    Shader (const char* vertex_path, const char* fragment_path, const std::vector<std::string>& defines = {}) {
 
         //char* u string
         std::string vertex_path_string(vertex_path);
         std::string fragment_path_string(fragment_path);
 
-        //dobijanje vertex/fragment koda iz fajlova
-        std::string vertex_code;
-        std::string fragment_code;
-        std::ifstream vertex_shader_file;
-        std::ifstream fragment_shader_file;
+        //dobijanje vertex/fragment koda iz fajlova, sa umetnutim #include fajlovima
+        rg::ShaderSource vertex_source;
+        rg::ShaderSource fragment_source;
+        rg::preprocessShader(vertex_path_string, vertex_source);
+        rg::preprocessShader(fragment_path_string, fragment_source);
 
-        //omogucavanje bacanja izuzetaka
-        vertex_shader_file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fragment_shader_file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        std::string defines_code;
+        for (const std::string& define : defines) {
+            defines_code += "#define " + define + "\n";
+        }
+        std::string vertex_code = insertDefines(vertex_source.m_code, defines_code);
+        std::string fragment_code = insertDefines(fragment_source.m_code, defines_code);
 
-        try {
+        //kes se trazi po paru shader-a i define-ovima, a vazi samo za isti izvorni kod i isti drajver
+        auto start = std::chrono::steady_clock::now();
+        uint64_t source_hash = rg::hashString(fragment_code.c_str(), rg::hashString(vertex_code.c_str()));
+        bool binary_cache = rg::ProgramCache::isSupported();
+        std::string cache_path = rg::ProgramCache::path(vertex_path_string, fragment_path_string, defines_code);
 
-            //otvaranje fajlova
-            vertex_shader_file.open(vertex_path);
-            fragment_shader_file.open(fragment_path);
+        m_id = glCreateProgram();
+        m_from_cache = binary_cache && rg::ProgramCache::load(m_id, cache_path, source_hash);
+        bool cache_written = false;
+        if (!m_from_cache) {
+            //program koji je drajver odbio se ne koristi ponovo
+            glDeleteProgram(m_id);
+            m_id = glCreateProgram();
+            bool linked = compile(vertex_code, fragment_code, vertex_source, fragment_source, binary_cache);
+            if (!linked) {
+                std::cerr << "ERROR::SHADER::NEUSPESNO_POVEZIVANJE " << vertex_path_string << " + " << fragment_path_string << "\n";
+            } else if (binary_cache) {
+                cache_written = rg::ProgramCache::store(m_id, cache_path, source_hash);
+            }
+        }
+        m_load_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
 
-            std::stringstream vertex_shader_stream;
-            std::stringstream fragment_shader_stream;
+        std::cout << "Shader " << vertex_path_string << " + " << fragment_path_string << ": ";
+        if (m_from_cache)
+            std::cout << "binarni kes " << m_load_ms << " ms\n";
+        else
+            std::cout << "kompajliranje " << m_load_ms << " ms" << (cache_written ? " (kes upisan)" : "") << "\n";
 
-            //ucitavanje sadrzaja u stream-ove
-            vertex_shader_stream << vertex_shader_file.rdbuf();
-            fragment_shader_stream << fragment_shader_file.rdbuf();
+        reflectUniforms();
+        bindUniformBlocks();
+    }
 
-            vertex_shader_file.close();
-            fragment_shader_file.close();
+    //aktiviranje shader-a
+    void use() {
+        glUseProgram(m_id);
+    }
 
-            //konvertovanje stream-ova u string
-            vertex_code = vertex_shader_stream.str();
-            fragment_code = fragment_shader_stream.str();
+    //lokacija uniform-a iz tabele popunjene pri povezivanju, bez upita GL-u; -1 ako ne postoji
+    int location(const rg::UniformName& name) const {
+        auto it = m_uniforms.find(name.m_hash);
+        return it == m_uniforms.end() ? -1 : it->second.m_location;
+    }
 
+    //tipiziran handle; pogresan tip se prijavljuje jednom, pri razresavanju
+    template <typename T>
+    rg::Uniform<T> uniform(const rg::UniformName& name) const {
+        rg::Uniform<T> handle;
+        auto it = m_uniforms.find(name.m_hash);
+        if (it == m_uniforms.end())
+            return handle;
+        if (!compatible(it->second.m_type, rg::UniformType<T>::value)) {
+            std::cerr << "ERROR::SHADER::UNIFORM_TYPE " << (name.m_name ? name.m_name : "?") << "\n";
+            return handle;
         }
-        catch (std::ifstream::failure &e) {
-            std::cerr << "ERROR::SHADER::NEUSPESNO_UCITAVANJE_FAJLA" << "\n";
-        }
+        handle.m_location = it->second.m_location;
+        return handle;
+    }
 
-        //string u char*
-        const char* vertex_shader_code = vertex_code.c_str();
-        const char* fragment_shader_code = fragment_code.c_str();
+    void set(rg::Uniform<int> uniform, int value) const {
+        glUniform1i(uniform.m_location, value);
+    }
 
-        //kompajliranje shader-a
-        unsigned int vertex, fragment;
+    //uint uniform se postavlja samo sa glUniform1ui, glUniform1i na njemu je GL_INVALID_OPERATION
+    void set(rg::Uniform<unsigned int> uniform, unsigned int value) const {
+        glUniform1ui(uniform.m_location, value);
+    }
 
-        //vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vertex_shader_code, NULL);
-        glCompileShader(vertex);
-        //CHECK ERRORS
+    void set(rg::Uniform<float> uniform, float value) const {
+        glUniform1f(uniform.m_location, value);
+    }
 
-        //fragment shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fragment_shader_code, NULL);
-        glCompileShader(fragment);
-        //CHECK ERRORS
+    void set(rg::Uniform<glm::vec2> uniform, const glm::vec2 &value) const {
+        glUniform2fv(uniform.m_location, 1, &value[0]);
+    }
 
-        //shader program
-        m_id = glCreateProgram();
-        glAttachShader(m_id, vertex);
-        glAttachShader(m_id, fragment);
+    void set(rg::Uniform<glm::vec3> uniform, const glm::vec3 &value) const {
+        glUniform3fv(uniform.m_location, 1, &value[0]);
+    }
 
-        glLinkProgram(m_id);
-        //CHECK ERRORS
+    void set(rg::Uniform<glm::vec4> uniform, const glm::vec4 &value) const {
+        glUniform4fv(uniform.m_location, 1, &value[0]);
+    }
 
-        //brisanje shader-a jer vise nisu potrebni
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+    void set(rg::Uniform<glm::mat2> uniform, const glm::mat2 &mat) const {
+        glUniformMatrix2fv(uniform.m_location, 1, GL_FALSE, &mat[0][0]);
+    }
 
+    void set(rg::Uniform<glm::mat3> uniform, const glm::mat3 &mat) const {
+        glUniformMatrix3fv(uniform.m_location, 1, GL_FALSE, &mat[0][0]);
     }
 
-    //aktiviranje shader-a
-    void use() {
-        glUseProgram(m_id);
+    void set(rg::Uniform<glm::mat4> uniform, const glm::mat4 &mat) const {
+        glUniformMatrix4fv(uniform.m_location, 1, GL_FALSE, &mat[0][0]);
     }
 
-    //korisne uniform funkcije
-    void setInt(const std::string &name, int value) const {
-        glUniform1i(glGetUniformLocation(m_id, name.c_str()), value);
+    //korisne uniform funkcije, lokacija se trazi po hesu imena u tabeli
+    void setInt(const rg::UniformName &name, int value) const {
+        glUniform1i(location(name), value);
     }
 
-    void setFloat(const std::string &name, float value) const {
-        glUniform1f(glGetUniformLocation(m_id, name.c_str()), value);
+    void setFloat(const rg::UniformName &name, float value) const {
+        glUniform1f(location(name), value);
     }
 
-    void setVec2 (const std::string &name, glm::vec2 &value) const {
-        glUniform2fv(glGetUniformLocation(m_id, name.c_str()), 1, &value[0]);
+    void setVec2 (const rg::UniformName &name, const glm::vec2 &value) const {
+        glUniform2fv(location(name), 1, &value[0]);
     }
 
-    void setVec2 (const std::string &name, float x, float y) const {
-        glUniform2f(glGetUniformLocation(m_id, name.c_str()), x, y);
+    void setVec2 (const rg::UniformName &name, float x, float y) const {
+        glUniform2f(location(name), x, y);
     }
 
-    void setVec3 (const std::string &name, glm::vec3 &value) const {
-        glUniform3fv(glGetUniformLocation(m_id, name.c_str()), 1, &value[0]);
+    void setVec3 (const rg::UniformName &name, const glm::vec3 &value) const {
+        glUniform3fv(location(name), 1, &value[0]);
     }
 
-    void setVec3 (const std::string &name, float x, float y, float z) const {
-        glUniform3f(glGetUniformLocation(m_id, name.c_str()), z, y, z);
+    void setVec3 (const rg::UniformName &name, float x, float y, float z) const {
+        glUniform3f(location(name), x, y, z);
     }
 
-    void setVec4 (const std::string &name, glm::vec4 &value) const {
-        glUniform4fv(glGetUniformLocation(m_id, name.c_str()), 1, &value[0]);
+    void setVec4 (const rg::UniformName &name, const glm::vec4 &value) const {
+        glUniform4fv(location(name), 1, &value[0]);
     }
 
-    void setVec4 (const std::string &name, float x, float y, float z, float w) const {
-        glUniform4f(glGetUniformLocation(m_id, name.c_str()), x, y, z, w);
+    void setVec4 (const rg::UniformName &name, float x, float y, float z, float w) const {
+        glUniform4f(location(name), x, y, z, w);
     }
 
-    void setMat2 (const std::string &name, const glm::mat2 &mat) const {
-        glUniformMatrix2fv(glGetUniformLocation(m_id, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    void setMat2 (const rg::UniformName &name, const glm::mat2 &mat) const {
+        glUniformMatrix2fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
 
-    void setMat3 (const std::string &name, const glm::mat3 &mat) const {
-        glUniformMatrix3fv(glGetUniformLocation(m_id, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    void setMat3 (const rg::UniformName &name, const glm::mat3 &mat) const {
+        glUniformMatrix3fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
 
-    void setMat4 (const std::string &name, const glm::mat4 &mat) const {
-        glUniformMatrix4fv(glGetUniformLocation(m_id, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    void setMat4 (const rg::UniformName &name, const glm::mat4 &mat) const {
+        glUniformMatrix4fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
-    //funkicja za proveru gresaka pri kompajliranju/povezivanju
-    //void check_errors(GLunit shader, std::string type)
+    struct UniformInfo {
+        int m_location;
+        GLenum m_type;
+    };
+
+    //aktivni uniform-i po hesu imena; niz je upisan pod imenom bez indeksa i pod svakim "ime[i]"
+    std::unordered_map<uint64_t, UniformInfo> m_uniforms;
+
+    void reflectUniforms() {
+        m_uniforms.clear();
+        GLint count = 0;
+        GLint max_length = 0;
+        glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+        std::vector<char> buffer((size_t) std::max(max_length, 1));
+
+        for (GLint i = 0; i < count; i++) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(m_id, (GLuint) i, (GLsizei) buffer.size(), &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), (size_t) length);
+            int location = glGetUniformLocation(m_id, name.c_str());
+            //uniform-i iz uniform blokova nemaju lokaciju
+            if (location < 0)
+                continue;
+
+            m_uniforms[rg::hashString(name.c_str())] = {location, type};
+            size_t bracket = name.find('[');
+            if (bracket == std::string::npos)
+                continue;
+
+            std::string base = name.substr(0, bracket);
+            m_uniforms[rg::hashString(base.c_str())] = {location, type};
+            for (GLint element = 1; element < size; element++) {
+                std::string element_name = base + "[" + std::to_string(element) + "]";
+                int element_location = glGetUniformLocation(m_id, element_name.c_str());
+                if (element_location >= 0) {
+                    m_uniforms[rg::hashString(element_name.c_str())] = {element_location, type};
+                }
+            }
+        }
+    }
+
+    //svaki blok se vezuje na tacku odredjenu njegovim imenom, pa svi programi dele iste bafere
+    void bindUniformBlocks() {
+        GLint count = 0;
+        glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+        for (GLint i = 0; i < count; i++) {
+            char name[256];
+            GLsizei length = 0;
+            glGetActiveUniformBlockName(m_id, (GLuint) i, sizeof(name), &length, name);
+            int binding = rg::uniformBlockBinding(std::string(name, (size_t) length));
+            if (binding < 0) {
+                std::cerr << "ERROR::SHADER::NEPOZNAT_UNIFORM_BLOK " << std::string(name, (size_t) length) << "\n";
+                continue;
+            }
+            glUniformBlockBinding(m_id, (GLuint) i, (GLuint) binding);
+        }
+    }
+
+    //int handle prihvata i bool i sampler-e, koji se postavljaju sa glUniform1i; uint ima svoj handle
+    static bool compatible(GLenum actual, GLenum expected) {
+        if (actual == expected)
+            return true;
+        if (expected != GL_INT)
+            return false;
+        switch (actual) {
+            case GL_BOOL:
+            case GL_SAMPLER_2D:
+            case GL_SAMPLER_3D:
+            case GL_SAMPLER_CUBE:
+            case GL_SAMPLER_2D_SHADOW:
+            case GL_SAMPLER_2D_ARRAY:
+            case GL_SAMPLER_2D_MULTISAMPLE:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    //kompajliranje i povezivanje iz izvornog koda; true ako je program povezan
+    //GL_LINK_STATUS ceka kraj povezivanja, pa izmereno vreme ukljucuje i rad drajvera
+    bool compile(const std::string& vertex_code, const std::string& fragment_code, const rg::ShaderSource& vertex_source,
+                 const rg::ShaderSource& fragment_source, bool retrievable) {
+        //string u char*
+        const char* vertex_shader_code = vertex_code.c_str();
+        const char* fragment_shader_code = fragment_code.c_str();
+
+        //kompajliranje shader-a
+        unsigned int vertex, fragment;
+
+        //vertex shader
+        vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vertex_shader_code, NULL);
+        glCompileShader(vertex);
+        checkCompileErrors(vertex, vertex_source);
+
+        //fragment shader
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fragment_shader_code, NULL);
+        glCompileShader(fragment);
+        checkCompileErrors(fragment, fragment_source);
+
+        //shader program; drajver mora unapred znati da ce se binarni program citati
+        glAttachShader(m_id, vertex);
+        glAttachShader(m_id, fragment);
+        if (retrievable) {
+            glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        glLinkProgram(m_id);
+
+        //brisanje shader-a jer vise nisu potrebni
+        glDetachShader(m_id, vertex);
+        glDetachShader(m_id, fragment);
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+
+        GLint status = GL_FALSE;
+        glGetProgramiv(m_id, GL_LINK_STATUS, &status);
+        if (status != GL_TRUE) {
+            char log[1024];
+            glGetProgramInfoLog(m_id, sizeof(log), NULL, log);
+            std::cerr << log << "\n";
+        }
+        return status == GL_TRUE;
+    }
+
+    //poruka kompajlera navodi broj izvora iz #line direktiva, pa se uz nju ispisuju i fajlovi
+    static void checkCompileErrors(unsigned int shader, const rg::ShaderSource& source) {
+        GLint status = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+        if (status == GL_TRUE)
+            return;
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        std::cerr << "ERROR::SHADER::NEUSPESNO_KOMPAJLIRANJE\n" << log << "\n";
+        for (size_t i = 0; i < source.m_files.size(); i++) {
+            std::cerr << "  " << i << ": " << source.m_files[i] << "\n";
+        }
+    }
+
+    //define-ovi idu posle #version, koja mora biti prva naredba shader-a; #line vraca brojeve linija fajla
+    static std::string insertDefines(const std::string& code, const std::string& defines_code) {
+        if (defines_code.empty())
+            return code;
+        size_t version = code.find("#version");
+        if (version == std::string::npos)
+            return defines_code + code;
+        size_t line_end = code.find('\n', version);
+        if (line_end == std::string::npos)
+            return code + "\n" + defines_code;
+        size_t next_line = (size_t) std::count(code.begin(), code.begin() + line_end, '\n') + 2;
+        return code.substr(0, line_end + 1) + defines_code + "#line " + std::to_string(next_line) + " 0\n" +
+               code.substr(line_end + 1);
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef PROJECT_BASE_SHADERPREPROCESSOR_H
+#define PROJECT_BASE_SHADERPREPROCESSOR_H
+
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace rg {
+
+//izvorni kod shader-a posle razresavanja #include-ova i fajlovi od kojih je sastavljen
+//indeks fajla u m_files je broj izvora u #line direktivama, pa ga GLSL kompajler navodi u porukama o greskama
+struct ShaderSource {
+    std::string m_code;
+    std::vector<std::string> m_files;
+};
+
+namespace detail {
+
+inline std::string directoryOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+//ime iz linije oblika #include "ime", prazno ako linija nije #include
+inline std::string includedName(const std::string& line) {
+    size_t start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line.compare(start, 8, "#include") != 0)
+        return std::string();
+    size_t open = line.find('"', start + 8);
+    size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+    if (close == std::string::npos)
+        return std::string();
+    return line.substr(open + 1, close - open - 1);
+}
+
+inline bool appendShaderFile(const std::string& path, ShaderSource& source) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "ERROR::SHADER::NEUSPESNO_UCITAVANJE_FAJLA " << path << "\n";
+        return false;
+    }
+
+    size_t index = source.m_files.size();
+    source.m_files.push_back(path);
+    //prvi fajl pocinje sa #version, pre koje ne sme da stoji nista
+    if (index > 0) {
+        source.m_code += "#line 1 " + std::to_string(index) + "\n";
+    }
+
+    std::string line;
+    unsigned int number = 0;
+    while (std::getline(file, line)) {
+        number++;
+        std::string name = includedName(line);
+        if (name.empty()) {
+            source.m_code += line;
+            source.m_code += '\n';
+            continue;
+        }
+
+        //svaki fajl se ukljucuje samo jednom, kao da ima #pragma once
+        std::string included = directoryOf(path) + name;
+        bool seen = false;
+        for (const std::string& file_path : source.m_files) {
+            seen = seen || file_path == included;
+        }
+        if (!seen && !appendShaderFile(included, source))
+            return false;
+        source.m_code += "#line " + std::to_string(number + 1) + " " + std::to_string(index) + "\n";
+    }
+    return true;
+}
+
+}
+
+//cita shader i rekurzivno umece fajlove iz #include "putanja", relativno prema fajlu koji ih ukljucuje
+//#include se razresava pre GLSL preprocesora, pa se fajl umece i kad je unutar #ifdef bloka
+inline bool preprocessShader(const std::string& path, ShaderSource& source) {
+    source.m_code.clear();
+    source.m_files.clear();
+    return detail::appendShaderFile(path, source);
+}
+
+}
+
+#endif //PROJECT_BASE_SHADERPREPROCESSOR_H
@@ -0,0 +1,96 @@
+#ifndef PROJECT_BASE_SHADERVARIANTS_H
+#define PROJECT_BASE_SHADERVARIANTS_H
+
+#include <rg/Shader.h>
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rg {
+
+//osobine varijante shader-a; svaka postaje define istog imena bez prefiksa SHADER_
+enum ShaderFeature : uint32_t {
+    SHADER_DIRECTIONAL_LIGHT = 1u << 0,
+    SHADER_SPOT_LIGHT = 1u << 1,
+    SHADER_POINT_LIGHT = 1u << 2,
+    SHADER_INSTANCED = 1u << 3,
+    SHADER_ALPHA_TEST = 1u << 4,
+    SHADER_NORMAL_MAP = 1u << 5,
+    SHADER_CLUSTERED_LIGHTS = 1u << 6,
+    SHADER_ALPHA_TO_COVERAGE = 1u << 7
+};
+
+inline std::vector<std::string> shaderDefines(uint32_t features) {
+    static const char* names[] = {"DIRECTIONAL_LIGHT", "SPOT_LIGHT", "POINT_LIGHT", "INSTANCED", "ALPHA_TEST", "NORMAL_MAP",
+                                   "CLUSTERED_LIGHTS", "ALPHA_TO_COVERAGE"};
+    std::vector<std::string> defines;
+    for (unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (features & (1u << i)) {
+            defines.push_back(names[i]);
+        }
+    }
+    return defines;
+}
+
+//kes varijanti jednog para shader-a: svaka kombinacija osobina se kompajlira (ili ucitava iz binarnog kesa)
+//samo pri prvom trazenju; setup se poziva jednom za svaki novi program, npr. za uniform-e koji se ne menjaju
+//varijante se ne brisu dok postoji kes, pa pokazivaci na njih ostaju vazeci
+class ShaderVariants {
+public:
+    ShaderVariants(std::string vertex_path, std::string fragment_path, std::function<void(Shader&)> setup = nullptr)
+            : m_vertex_path(std::move(vertex_path)), m_fragment_path(std::move(fragment_path)), m_setup(std::move(setup)) {}
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    Shader& get(uint32_t features) {
+        features &= ~m_ignored_features;
+        //ALPHA_TO_COVERAGE menja samo alfa test, bez njega bi varijanta bila ista kao bez te osobine
+        if (!(features & SHADER_ALPHA_TEST)) {
+            features &= ~SHADER_ALPHA_TO_COVERAGE;
+        }
+        auto it = m_variants.find(features);
+        if (it != m_variants.end())
+            return *it->second;
+
+        std::unique_ptr<Shader> shader(new Shader(m_vertex_path.c_str(), m_fragment_path.c_str(), shaderDefines(features)));
+        m_load_ms += shader->m_load_ms;
+        m_from_cache += shader->m_from_cache ? 1 : 0;
+        if (m_setup) {
+            m_setup(*shader);
+        }
+        return *m_variants.emplace(features, std::move(shader)).first->second;
+    }
+
+    //osobine koje get zanemaruje, npr. ALPHA_TEST kad je dubina vec upisana prolazom samo dubine
+    void setIgnoredFeatures(uint32_t features) {
+        m_ignored_features = features;
+    }
+
+    size_t size() const {
+        return m_variants.size();
+    }
+
+    void printStats(std::ostream& out) const {
+        out << "Varijante " << m_vertex_path << " + " << m_fragment_path << ": " << m_variants.size() << " ("
+            << m_from_cache << " iz binarnog kesa), ukupno " << m_load_ms << " ms\n";
+    }
+
+private:
+    std::string m_vertex_path;
+    std::string m_fragment_path;
+    std::function<void(Shader&)> m_setup;
+    std::unordered_map<uint32_t, std::unique_ptr<Shader>> m_variants;
+    float m_load_ms = 0.0f;
+    size_t m_from_cache = 0;
+    uint32_t m_ignored_features = 0;
+};
+
+}
+
+#endif //PROJECT_BASE_SHADERVARIANTS_H
@@ -0,0 +1,477 @@
+#ifndef PROJECT_BASE_TEXTURECACHE_H
+#define PROJECT_BASE_TEXTURECACHE_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <rg/BlockCompression.h>
+#include <rg/GLCapabilities.h>
+#include <rg/Hash.h>
+#include <rg/MappedFile.h>
+#include <rg/ThreadPool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//S3TC formati nisu deo core profila pa ih GLAD bez prosirenja ne definise
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace rg {
+
+//normalne mape se kompresuju u dva kanala (BC5), pa se za istu sliku cuvaju odvojeno od boje
+enum class TextureUsage {
+    Color,
+    Normal
+};
+
+enum class BlockFormat : uint32_t {
+    BC1 = 1,
+    BC3 = 3,
+    BC4 = 4,
+    BC5 = 5
+};
+
+inline size_t blockBytes(BlockFormat format) {
+    return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+}
+
+inline GLenum glInternalFormat(BlockFormat format) {
+    switch (format) {
+        case BlockFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case BlockFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case BlockFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+        case BlockFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+    }
+    return GL_NONE;
+}
+
+//RGTC je deo OpenGL 3.0, S3TC je prosirenje koje skoro svi desktop drajveri imaju
+inline bool isBlockFormatSupported(BlockFormat format) {
+    if (format == BlockFormat::BC4 || format == BlockFormat::BC5) {
+        return true;
+    }
+    return hasGLExtension("GL_EXT_texture_compression_s3tc");
+}
+
+struct TextureLevel {
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<unsigned char> m_data;
+};
+
+//kompresovana tekstura sa svim mipmap nivoima, spremna za glCompressedTexImage2D
+struct CompressedTexture {
+    std::string m_path;
+    BlockFormat m_format = BlockFormat::BC1;
+    int m_source_components = 0;
+    bool m_from_cache = false;
+    std::vector<TextureLevel> m_levels;
+
+    bool isValid() const {
+        return !m_levels.empty();
+    }
+
+    //BC3 se bira samo kad slika ima bar jedan piksel koji nije potpuno neprovidan
+    bool hasAlpha() const {
+        return m_format == BlockFormat::BC3;
+    }
+
+    size_t compressedBytes() const {
+        size_t bytes = 0;
+        for (const TextureLevel& level : m_levels) {
+            bytes += level.m_data.size();
+        }
+        return bytes;
+    }
+
+    //koliko bi isti nivoi zauzimali nekompresovani, u formatu izvorne slike
+    size_t uncompressedBytes() const {
+        size_t bytes = 0;
+        for (const TextureLevel& level : m_levels) {
+            bytes += (size_t) level.m_width * level.m_height * m_source_components;
+        }
+        return bytes;
+    }
+};
+
+const uint32_t TEXTURE_CACHE_MAGIC = 0x58544752; // "RGTX"
+//verzija 2: mipmap nivoi tekstura sa alfom cuvaju pokrivenost alfa testa
+const uint32_t TEXTURE_CACHE_VERSION = 2;
+
+//prag alfa testa, isti kao ALPHA_CUTOFF u material.glsl
+const float ALPHA_TEST_CUTOFF = 0.8f;
+
+//kes kompresovanih tekstura u DDS fajlovima pored izvornih slika
+//podaci o izvoru (hes, namena, broj kanala) se cuvaju u rezervisanim poljima DDS zaglavlja
+class TextureCache {
+public:
+    static std::string cachePath(const std::string& path, TextureUsage usage) {
+        return path + (usage == TextureUsage::Normal ? ".normal.cache.dds" : ".cache.dds");
+    }
+
+    //ucitava teksturu iz kesa, a ako kes ne postoji ili je zastareo pravi ga iz izvorne slike
+    static CompressedTexture load(const std::string& path, TextureUsage usage) {
+        std::string cache_path = cachePath(path, usage);
+        uint64_t source_hash = hashFile(path);
+
+        CompressedTexture texture;
+        texture.m_path = path;
+        if (source_hash != 0 && read(cache_path, source_hash, usage, texture)) {
+            texture.m_from_cache = true;
+            return texture;
+        }
+
+        texture = build(path, usage);
+        if (texture.isValid()) {
+            write(cache_path, source_hash, usage, texture);
+        }
+        return texture;
+    }
+
+    //dekodiranje slike, racunanje svih mipmap nivoa i blok kompresija
+    static CompressedTexture build(const std::string& path, TextureUsage usage) {
+        CompressedTexture texture;
+        texture.m_path = path;
+
+        int width, height, components;
+        if (!stbi_info(path.c_str(), &width, &height, &components)) {
+            return texture;
+        }
+
+        //jednokanalne slike ostaju jednokanalne, sve ostale se prosiruju na RGBA
+        int channels = components == 1 && usage == TextureUsage::Color ? 1 : 4;
+        unsigned char* data = stbi_load(path.c_str(), &width, &height, &components, channels);
+        if (!data) {
+            return texture;
+        }
+        std::vector<unsigned char> pixels(data, data + (size_t) width * height * channels);
+        stbi_image_free(data);
+
+        texture.m_source_components = components;
+        if (usage == TextureUsage::Normal) {
+            texture.m_format = BlockFormat::BC5;
+        } else if (channels == 1) {
+            texture.m_format = BlockFormat::BC4;
+        } else {
+            bool has_alpha = false;
+            for (size_t i = 3; i < pixels.size() && !has_alpha; i += 4) {
+                has_alpha = pixels[i] != 255;
+            }
+            texture.m_format = has_alpha ? BlockFormat::BC3 : BlockFormat::BC1;
+        }
+
+        //nivoi se racunaju iz neskaliranog prethodnog nivoa, skalirana alfa ide samo u kompresiju
+        bool preserve_coverage = texture.m_format == BlockFormat::BC3;
+        float coverage = preserve_coverage ? alphaCoverage(pixels, 1.0f) : 0.0f;
+        std::vector<unsigned char> scaled;
+        while (true) {
+            const std::vector<unsigned char>* source = &pixels;
+            if (preserve_coverage && !texture.m_levels.empty()) {
+                scaled = preserveCoverage(pixels, coverage);
+                source = &scaled;
+            }
+
+            TextureLevel level;
+            level.m_width = width;
+            level.m_height = height;
+            level.m_data = compressLevel(source->data(), width, height, channels, texture.m_format);
+            texture.m_levels.push_back(std::move(level));
+
+            if (width == 1 && height == 1) {
+                break;
+            }
+            pixels = downsample(pixels, width, height, channels);
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+
+        return texture;
+    }
+
+    //softversko raspakivanje BC1/BC3 nivoa u RGBA8, kada drajver nema S3TC
+    static std::vector<unsigned char> decompressLevel(const TextureLevel& level, BlockFormat format) {
+        std::vector<unsigned char> rgba((size_t) level.m_width * level.m_height * 4);
+        int blocks_x = (level.m_width + 3) / 4;
+        int blocks_y = (level.m_height + 3) / 4;
+        size_t block_size = blockBytes(format);
+
+        for (int by = 0; by < blocks_y; by++) {
+            for (int bx = 0; bx < blocks_x; bx++) {
+                const unsigned char* block = level.m_data.data() + ((size_t) by * blocks_x + bx) * block_size;
+                unsigned char decoded[16 * 4];
+                if (format == BlockFormat::BC3) {
+                    unsigned char alpha[16];
+                    bc::decodeChannelBlock(block, alpha);
+                    bc::decodeColorBlock(block + 8, decoded, true);
+                    for (int p = 0; p < 16; p++) {
+                        decoded[p * 4 + 3] = alpha[p];
+                    }
+                } else {
+                    bc::decodeColorBlock(block, decoded, false);
+                }
+
+                for (int y = 0; y < 4 && by * 4 + y < level.m_height; y++) {
+                    for (int x = 0; x < 4 && bx * 4 + x < level.m_width; x++) {
+                        size_t pixel = (size_t) (by * 4 + y) * level.m_width + bx * 4 + x;
+                        std::memcpy(&rgba[pixel * 4], &decoded[(y * 4 + x) * 4], 4);
+                    }
+                }
+            }
+        }
+        return rgba;
+    }
+
+private:
+    struct DdsPixelFormat {
+        uint32_t m_size;
+        uint32_t m_flags;
+        uint32_t m_four_cc;
+        uint32_t m_rgb_bit_count;
+        uint32_t m_masks[4];
+    };
+
+    struct DdsHeader {
+        uint32_t m_size;
+        uint32_t m_flags;
+        uint32_t m_height;
+        uint32_t m_width;
+        uint32_t m_linear_size;
+        uint32_t m_depth;
+        uint32_t m_mip_map_count;
+        uint32_t m_reserved1[11];
+        DdsPixelFormat m_pixel_format;
+        uint32_t m_caps[4];
+        uint32_t m_reserved2;
+    };
+
+    static uint32_t fourCC(char a, char b, char c, char d) {
+        return (uint32_t) (unsigned char) a | ((uint32_t) (unsigned char) b << 8) |
+               ((uint32_t) (unsigned char) c << 16) | ((uint32_t) (unsigned char) d << 24);
+    }
+
+    static uint32_t formatFourCC(BlockFormat format) {
+        switch (format) {
+            case BlockFormat::BC1: return fourCC('D', 'X', 'T', '1');
+            case BlockFormat::BC3: return fourCC('D', 'X', 'T', '5');
+            case BlockFormat::BC4: return fourCC('A', 'T', 'I', '1');
+            case BlockFormat::BC5: return fourCC('A', 'T', 'I', '2');
+        }
+        return 0;
+    }
+
+    static size_t levelBytes(int width, int height, BlockFormat format) {
+        return (size_t) ((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+    }
+
+    static bool read(const std::string& cache_path, uint64_t source_hash, TextureUsage usage, CompressedTexture& texture) {
+        MappedFile file(cache_path);
+        if (!file.isOpen() || file.size() < 4 + sizeof(DdsHeader) || std::memcmp(file.data(), "DDS ", 4) != 0) {
+            return false;
+        }
+
+        DdsHeader header;
+        std::memcpy(&header, file.data() + 4, sizeof(header));
+        if (header.m_size != sizeof(DdsHeader) || header.m_reserved1[0] != TEXTURE_CACHE_MAGIC ||
+            header.m_reserved1[1] != TEXTURE_CACHE_VERSION ||
+            header.m_reserved1[2] != (uint32_t) source_hash || header.m_reserved1[3] != (uint32_t) (source_hash >> 32) ||
+            header.m_reserved1[4] != (uint32_t) usage) {
+            return false;
+        }
+
+        BlockFormat format = (BlockFormat) header.m_reserved1[5];
+        if (formatFourCC(format) == 0 || formatFourCC(format) != header.m_pixel_format.m_four_cc) {
+            return false;
+        }
+
+        texture.m_format = format;
+        texture.m_source_components = (int) header.m_reserved1[6];
+        texture.m_levels.clear();
+
+        size_t offset = 4 + sizeof(DdsHeader);
+        int width = (int) header.m_width;
+        int height = (int) header.m_height;
+        for (uint32_t i = 0; i < header.m_mip_map_count; i++) {
+            size_t size = levelBytes(width, height, format);
+            if (file.size() - offset < size) {
+                std::cerr << "ERROR::TEXTURE_CACHE::OSTECEN_KES " << cache_path << "\n";
+                texture.m_levels.clear();
+                return false;
+            }
+
+            TextureLevel level;
+            level.m_width = width;
+            level.m_height = height;
+            level.m_data.assign(file.data() + offset, file.data() + offset + size);
+            texture.m_levels.push_back(std::move(level));
+
+            offset += size;
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        return texture.isValid();
+    }
+
+    static bool write(const std::string& cache_path, uint64_t source_hash, TextureUsage usage, const CompressedTexture& texture) {
+        DdsHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.m_size = sizeof(DdsHeader);
+        //CAPS | HEIGHT | WIDTH | PIXELFORMAT | MIPMAPCOUNT | LINEARSIZE
+        header.m_flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;
+        header.m_height = (uint32_t) texture.m_levels[0].m_height;
+        header.m_width = (uint32_t) texture.m_levels[0].m_width;
+        header.m_linear_size = (uint32_t) texture.m_levels[0].m_data.size();
+        header.m_mip_map_count = (uint32_t) texture.m_levels.size();
+        header.m_reserved1[0] = TEXTURE_CACHE_MAGIC;
+        header.m_reserved1[1] = TEXTURE_CACHE_VERSION;
+        header.m_reserved1[2] = (uint32_t) source_hash;
+        header.m_reserved1[3] = (uint32_t) (source_hash >> 32);
+        header.m_reserved1[4] = (uint32_t) usage;
+        header.m_reserved1[5] = (uint32_t) texture.m_format;
+        header.m_reserved1[6] = (uint32_t) texture.m_source_components;
+        header.m_pixel_format.m_size = sizeof(DdsPixelFormat);
+        header.m_pixel_format.m_flags = 0x4; // FOURCC
+        header.m_pixel_format.m_four_cc = formatFourCC(texture.m_format);
+        //TEXTURE | COMPLEX | MIPMAP
+        header.m_caps[0] = 0x1000 | 0x8 | 0x400000;
+
+        std::string temporary_path = temporaryPath(cache_path);
+        std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+        out.write("DDS ", 4);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const TextureLevel& level : texture.m_levels) {
+            out.write(reinterpret_cast<const char*>(level.m_data.data()), level.m_data.size());
+        }
+        out.close();
+
+        if (!out || std::rename(temporary_path.c_str(), cache_path.c_str()) != 0) {
+            std::cerr << "ERROR::TEXTURE_CACHE::NEUSPESNO_PISANJE " << cache_path << "\n";
+            std::remove(temporary_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    //sledeci mipmap nivo usrednjavanjem 2x2 piksela, neparne dimenzije ponavljaju poslednju kolonu/vrstu
+    static std::vector<unsigned char> downsample(const std::vector<unsigned char>& pixels, int width, int height, int channels) {
+        int next_width = std::max(1, width / 2);
+        int next_height = std::max(1, height / 2);
+        std::vector<unsigned char> next((size_t) next_width * next_height * channels);
+
+        for (int y = 0; y < next_height; y++) {
+            int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+            for (int x = 0; x < next_width; x++) {
+                int x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+                for (int c = 0; c < channels; c++) {
+                    int sum = pixels[((size_t) y0 * width + x0) * channels + c] + pixels[((size_t) y0 * width + x1) * channels + c] +
+                              pixels[((size_t) y1 * width + x0) * channels + c] + pixels[((size_t) y1 * width + x1) * channels + c];
+                    next[((size_t) y * next_width + x) * channels + c] = (unsigned char) ((sum + 2) / 4);
+                }
+            }
+        }
+        return next;
+    }
+
+    //udeo RGBA piksela cija alfa, pomnozena sa scale, prolazi alfa test
+    static float alphaCoverage(const std::vector<unsigned char>& pixels, float scale) {
+        const float cutoff = ALPHA_TEST_CUTOFF * 255.0f;
+        size_t covered = 0;
+        for (size_t i = 3; i < pixels.size(); i += 4) {
+            covered += pixels[i] * scale >= cutoff ? 1 : 0;
+        }
+        return pixels.empty() ? 0.0f : (float) covered / (float) (pixels.size() / 4);
+    }
+
+    //usrednjavanje alfe smanjuje udeo piksela iznad praga, pa bi retko lisce na manjim nivoima nestajalo
+    //alfa nivoa se mnozi najmanjom skalom sa kojom je pokrivenost bar kao na nivou 0 (pokrivenost raste sa skalom,
+    //pa se skala trazi binarnom pretragom)
+    static std::vector<unsigned char> preserveCoverage(const std::vector<unsigned char>& pixels, float coverage) {
+        float low = 0.0f, high = 16.0f;
+        for (int i = 0; i < 16; i++) {
+            float middle = 0.5f * (low + high);
+            if (alphaCoverage(pixels, middle) < coverage) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+
+        std::vector<unsigned char> scaled = pixels;
+        for (size_t i = 3; i < scaled.size(); i += 4) {
+            scaled[i] = (unsigned char) std::min(255.0f, std::floor(pixels[i] * high + 0.5f));
+        }
+        return scaled;
+    }
+
+    static std::vector<unsigned char> compressLevel(const unsigned char* pixels, int width, int height, int channels, BlockFormat format) {
+        int blocks_x = (width + 3) / 4;
+        int blocks_y = (height + 3) / 4;
+        size_t block_size = blockBytes(format);
+        std::vector<unsigned char> blocks((size_t) blocks_x * blocks_y * block_size);
+
+        for (int by = 0; by < blocks_y; by++) {
+            for (int bx = 0; bx < blocks_x; bx++) {
+                //blok van ivica slike ponavlja ivicne piksele
+                unsigned char rgba[16 * 4];
+                unsigned char first[16], second[16];
+                for (int y = 0; y < 4; y++) {
+                    for (int x = 0; x < 4; x++) {
+                        int sx = std::min(bx * 4 + x, width - 1);
+                        int sy = std::min(by * 4 + y, height - 1);
+                        const unsigned char* pixel = pixels + ((size_t) sy * width + sx) * channels;
+                        int p = y * 4 + x;
+                        for (int c = 0; c < 4; c++) {
+                            rgba[p * 4 + c] = c < channels ? pixel[c] : 255;
+                        }
+                        first[p] = pixel[0];
+                        second[p] = channels > 1 ? pixel[1] : 0;
+                    }
+                }
+
+                unsigned char* out = blocks.data() + ((size_t) by * blocks_x + bx) * block_size;
+                switch (format) {
+                    case BlockFormat::BC1:
+                        bc::encodeColorBlock(rgba, out);
+                        break;
+                    case BlockFormat::BC3: {
+                        unsigned char alpha[16];
+                        for (int p = 0; p < 16; p++) {
+                            alpha[p] = rgba[p * 4 + 3];
+                        }
+                        bc::encodeChannelBlock(alpha, out);
+                        bc::encodeColorBlock(rgba, out + 8);
+                        break;
+                    }
+                    case BlockFormat::BC4:
+                        bc::encodeChannelBlock(first, out);
+                        break;
+                    case BlockFormat::BC5:
+                        bc::encodeChannelBlock(first, out);
+                        bc::encodeChannelBlock(second, out + 8);
+                        break;
+                }
+            }
+        }
+        return blocks;
+    }
+};
+
+inline std::shared_future<CompressedTexture> loadCompressedTextureAsync(const std::string& path, TextureUsage usage) {
+    return ThreadPool::instance().submit([path, usage] { return TextureCache::load(path, usage); }).share();
+}
+
+}
+
+#endif //PROJECT_BASE_TEXTURECACHE_H
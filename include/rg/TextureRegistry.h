@@ -0,0 +1,122 @@
+#ifndef PROJECT_BASE_TEXTUREREGISTRY_H
+#define PROJECT_BASE_TEXTUREREGISTRY_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+namespace rg {
+
+//tekstura deljena izmedju modela
+struct TextureEntry {
+    unsigned int m_id = 0;
+    unsigned int m_references = 0;
+    size_t m_gpu_bytes = 0;
+    size_t m_uncompressed_bytes = 0;
+    bool m_has_alpha = false;
+};
+
+//globalni registar tekstura: svaka slika se salje na GPU jednom, bez obzira koliko je modela koristi
+//koristi se samo sa GL niti
+class TextureRegistry {
+public:
+    static TextureRegistry& instance() {
+        static TextureRegistry registry;
+        return registry;
+    }
+
+    //apsolutna putanja bez "..", "." i simbolickih linkova, da bi ista slika uvek imala isti kljuc
+    static std::string canonicalPath(const std::string& path) {
+        char resolved[PATH_MAX];
+        if (realpath(path.c_str(), resolved) == nullptr) {
+            return path;
+        }
+        return std::string(resolved);
+    }
+
+    bool contains(const std::string& canonical_path) const {
+        return m_textures.find(canonical_path) != m_textures.end();
+    }
+
+    //vraca id vec ucitane teksture i povecava broj referenci, 0 ako tekstura nije ucitana
+    unsigned int acquire(const std::string& canonical_path) {
+        auto it = m_textures.find(canonical_path);
+        if (it == m_textures.end()) {
+            return 0;
+        }
+        it->second.m_references++;
+        return it->second.m_id;
+    }
+
+    //dodaje tek ucitanu teksturu sa jednom referencom; uncompressed_bytes je velicina bez blok kompresije
+    void insert(const std::string& canonical_path, unsigned int id, size_t gpu_bytes, size_t uncompressed_bytes = 0,
+                bool has_alpha = false) {
+        TextureEntry& entry = m_textures[canonical_path];
+        entry.m_id = id;
+        entry.m_references = 1;
+        entry.m_gpu_bytes = gpu_bytes;
+        entry.m_uncompressed_bytes = std::max(gpu_bytes, uncompressed_bytes);
+        entry.m_has_alpha = has_alpha;
+        m_paths_by_id[id] = canonical_path;
+    }
+
+    //da li tekstura ima providne piksele; materijali bez njih crtaju se varijantom shader-a bez alfa testa
+    bool hasAlpha(unsigned int id) const {
+        auto path = m_paths_by_id.find(id);
+        return path != m_paths_by_id.end() && m_textures.at(path->second).m_has_alpha;
+    }
+
+    //smanjuje broj referenci i brise teksturu sa GPU-a kada vise niko ne koristi
+    void release(unsigned int id) {
+        auto path = m_paths_by_id.find(id);
+        if (path == m_paths_by_id.end()) {
+            return;
+        }
+
+        auto it = m_textures.find(path->second);
+        if (--it->second.m_references == 0) {
+            glDeleteTextures(1, &it->second.m_id);
+            m_textures.erase(it);
+            m_paths_by_id.erase(path);
+        }
+    }
+
+    size_t gpuBytes() const {
+        size_t total = 0;
+        for (const auto& texture : m_textures) {
+            total += texture.second.m_gpu_bytes;
+        }
+        return total;
+    }
+
+    size_t uncompressedBytes() const {
+        size_t total = 0;
+        for (const auto& texture : m_textures) {
+            total += texture.second.m_uncompressed_bytes;
+        }
+        return total;
+    }
+
+    void printStats(std::ostream& out) const {
+        out << "Teksture na GPU-u: " << m_textures.size() << ", " << gpuBytes() / 1024 << " KB"
+            << " (usteda kompresijom " << (uncompressedBytes() - gpuBytes()) / 1024 << " KB)\n";
+        for (const auto& texture : m_textures) {
+            out << "  " << texture.first << ": " << texture.second.m_gpu_bytes / 1024 << " KB"
+                << " (nekompresovano " << texture.second.m_uncompressed_bytes / 1024 << " KB), "
+                << texture.second.m_references << " ref.\n";
+        }
+    }
+
+private:
+    std::unordered_map<std::string, TextureEntry> m_textures;
+    std::unordered_map<unsigned int, std::string> m_paths_by_id;
+};
+
+}
+
+#endif //PROJECT_BASE_TEXTUREREGISTRY_H
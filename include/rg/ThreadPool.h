@@ -0,0 +1,101 @@
+#ifndef PROJECT_BASE_THREADPOOL_H
+#define PROJECT_BASE_THREADPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace rg {
+
+//skup radnih niti za poslove koji ne koriste OpenGL (dekodiranje slika, obrada mesh-eva)
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int thread_count) {
+        for (unsigned int i = 0; i < thread_count; i++) {
+            m_threads.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //zajednicki skup sa po jednom niti za svako jezgro
+    static ThreadPool& instance() {
+        static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+        return pool;
+    }
+
+    unsigned int threadCount() const {
+        return (unsigned int) m_threads.size();
+    }
+
+    //niti koje bi odmah preuzele novi posao: ne rade nista i nijedan posao ne ceka u redu
+    //posao iz frejma sme da se deli samo na njih, inace bi cekao ucitavanje i kompresiju koji su vec u redu
+    unsigned int idleThreads() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t waiting = m_busy + m_tasks.size();
+        return waiting >= m_threads.size() ? 0 : (unsigned int) (m_threads.size() - waiting);
+    }
+
+    //dodaje posao u red, rezultat (ili izuzetak) se dobija preko future-a
+    template <typename Function>
+    auto submit(Function&& function) -> std::future<decltype(function())> {
+        using Result = decltype(function());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+        std::future<Result> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push([task] { (*task)(); });
+        }
+        m_condition.notify_one();
+        return result;
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping = false;
+    size_t m_busy = 0; // niti koje trenutno izvrsavaju posao
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                if (m_stopping && m_tasks.empty()) {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop();
+                m_busy++;
+            }
+            task();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy--;
+        }
+    }
+};
+
+}
+
+#endif //PROJECT_BASE_THREADPOOL_H
@@ -0,0 +1,144 @@
+#ifndef PROJECT_BASE_UNIFORMBUFFER_H
+#define PROJECT_BASE_UNIFORMBUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/FrameStats.h>
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace rg {
+
+//tacke vezivanja uniform blokova, iste u svim programima
+enum UniformBlockBinding : unsigned int {
+    FRAME_BLOCK_BINDING = 0,
+    LIGHT_BLOCK_BINDING = 1,
+    CLUSTER_BLOCK_BINDING = 2
+};
+
+//tacka vezivanja za ime bloka iz shader-a, -1 za nepoznat blok
+inline int uniformBlockBinding(const std::string& name) {
+    if (name == "FrameData")
+        return FRAME_BLOCK_BINDING;
+    if (name == "LightData")
+        return LIGHT_BLOCK_BINDING;
+    if (name == "ClusterData")
+        return CLUSTER_BLOCK_BINDING;
+    return -1;
+}
+
+//std140 kopije blokova iz shader-a; vec3 zauzima 16 bajtova osim ako iza njega ne dolazi float
+//popune su inicijalizovane nulom jer UniformBuffer poredi bajtove
+
+//layout(std140) uniform FrameData { mat4 projection; mat4 view; vec4 cameraPosition; float time; };
+struct FrameData {
+    glm::mat4 m_projection = glm::mat4(1.0f);
+    glm::mat4 m_view = glm::mat4(1.0f);
+    glm::vec4 m_camera_position = glm::vec4(0.0f);
+    float m_time = 0.0f;
+    float m_padding[3] = {0.0f, 0.0f, 0.0f};
+};
+
+//struct DirLight { vec3 m_direction; vec3 m_ambient; vec3 m_diffuse; vec3 m_specular; };
+struct DirLightBlock {
+    glm::vec3 m_direction = glm::vec3(0.0f);
+    float m_padding0 = 0.0f;
+    glm::vec3 m_ambient = glm::vec3(0.0f);
+    float m_padding1 = 0.0f;
+    glm::vec3 m_diffuse = glm::vec3(0.0f);
+    float m_padding2 = 0.0f;
+    glm::vec3 m_specular = glm::vec3(0.0f);
+    float m_padding3 = 0.0f;
+};
+
+//struct SpotLight { vec3 m_position; vec3 m_direction; float m_cutOff; float m_outerCutOff;
+//                   vec3 m_ambient; vec3 m_diffuse; vec3 m_specular; float m_constant; float m_linear; float m_quadratic; };
+struct SpotLightBlock {
+    glm::vec3 m_position = glm::vec3(0.0f);
+    float m_padding0 = 0.0f;
+    glm::vec3 m_direction = glm::vec3(0.0f);
+    float m_cut_off = 0.0f;
+    float m_outer_cut_off = 0.0f;
+    float m_padding1[3] = {0.0f, 0.0f, 0.0f};
+    glm::vec3 m_ambient = glm::vec3(0.0f);
+    float m_padding2 = 0.0f;
+    glm::vec3 m_diffuse = glm::vec3(0.0f);
+    float m_padding3 = 0.0f;
+    glm::vec3 m_specular = glm::vec3(0.0f);
+    float m_constant = 0.0f;
+    float m_linear = 0.0f;
+    float m_quadratic = 0.0f;
+    float m_padding4[2] = {0.0f, 0.0f};
+};
+
+//layout(std140) uniform LightData { DirLight directional_light; SpotLight light; };
+struct LightData {
+    DirLightBlock m_directional;
+    SpotLightBlock m_spot;
+};
+
+//layout(std140) uniform ClusterData { uvec4 clusterGrid; vec4 clusterDepth; };
+//grid: broj klastera po x, y i z i broj svetala; depth: skala i pomeraj logaritma dubine, velicina plocice u pikselima
+struct ClusterData {
+    glm::uvec4 m_grid = glm::uvec4(0);
+    glm::vec4 m_depth = glm::vec4(0.0f);
+};
+
+static_assert(sizeof(FrameData) == 160 && offsetof(FrameData, m_camera_position) == 128, "FrameData nije std140");
+static_assert(sizeof(DirLightBlock) == 64, "DirLight nije std140");
+static_assert(offsetof(SpotLightBlock, m_cut_off) == 28 && offsetof(SpotLightBlock, m_ambient) == 48 &&
+              offsetof(SpotLightBlock, m_constant) == 92 && sizeof(SpotLightBlock) == 112, "SpotLight nije std140");
+static_assert(offsetof(LightData, m_spot) == 64, "LightData nije std140");
+static_assert(offsetof(ClusterData, m_depth) == 16 && sizeof(ClusterData) == 32, "ClusterData nije std140");
+
+//uniform buffer sa jednim blokom T, stalno vezan na svoju tacku
+//update salje podatke samo kad se razlikuju od poslednjih poslatih
+template <typename T>
+class UniformBuffer {
+public:
+    explicit UniformBuffer(unsigned int binding) : m_binding(binding) {}
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    ~UniformBuffer() {
+        if (m_buffer != 0) {
+            glDeleteBuffers(1, &m_buffer);
+        }
+    }
+
+    //true ako je blok poslat na GPU
+    bool update(const T& data) {
+        if (m_buffer == 0) {
+            glGenBuffers(1, &m_buffer);
+            glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+            glBindBufferBase(GL_UNIFORM_BUFFER, m_binding, m_buffer);
+        } else if (std::memcmp(&m_last, &data, sizeof(T)) == 0) {
+            return false;
+        } else {
+            glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+        }
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        m_last = data;
+        FrameStats::instance().recordUniformUpload(sizeof(T));
+        return true;
+    }
+
+    unsigned int binding() const {
+        return m_binding;
+    }
+
+private:
+    unsigned int m_binding;
+    unsigned int m_buffer = 0;
+    T m_last;
+};
+
+}
+
+#endif //PROJECT_BASE_UNIFORMBUFFER_H
@@ -0,0 +1,272 @@
+#ifndef PROJECT_BASE_VERTEXLAYOUT_H
+#define PROJECT_BASE_VERTEXLAYOUT_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//pun format verteksa koji se koristi pri importu i obradi mesh-eva
+struct Vertex {
+    glm::vec3 m_position;
+    glm::vec3 m_normal;
+    glm::vec2 m_texture_coordinates;
+    glm::vec3 m_tangent;
+    glm::vec3 m_bitangent;
+};
+
+namespace rg {
+
+//opis jednog atributa verteksa za glVertexAttribPointer
+struct VertexAttribute {
+    GLuint m_location;
+    GLint m_components;
+    GLenum m_type;
+    GLboolean m_normalized;
+    size_t m_offset;
+};
+
+//model matrica instance zauzima cetiri uzastopne lokacije, iza atributa svih formata verteksa
+const GLuint INSTANCE_MATRIX_LOCATION = 5;
+
+//format u kome se verteksi salju na GPU; lokacije atributa su iste u svim formatima
+//Full - 56 bajtova float32, sa tangentom i bitangentom
+//Packed - 20 bajtova: float32 pozicija, snorm 10-10-10-2 normala, half float UV
+//PackedTangent - 24 bajta: Packed + snorm tangenta sa znakom bitangente u w
+//PackedWideUv, PackedTangentWideUv - 24 i 28 bajtova: isto, ali sa float32 UV, za mesh-eve cije UV koordinate
+//prelaze HALF_UV_LIMIT (ponavljane teksture); Mesh ih bira sam, iz resolveVertexFormat
+enum class VertexFormat {
+    Full,
+    Packed,
+    PackedTangent,
+    PackedWideUv,
+    PackedTangentWideUv
+};
+
+//half float ima 10 bita mantise: do |uv| = 2 je greska najvise 1/2048, a oko 10 vec 1/256, sto se na
+//ponavljanoj teksturi vidi kao plivanje i stepenice
+const float HALF_UV_LIMIT = 2.0f;
+
+//format u kome mesh ide na GPU: Packed formati prelaze na float32 UV ako bi half float bio pregrub
+inline VertexFormat resolveVertexFormat(VertexFormat requested, const std::vector<Vertex>& vertices) {
+    if (requested != VertexFormat::Packed && requested != VertexFormat::PackedTangent)
+        return requested;
+    for (const Vertex& vertex : vertices) {
+        if (std::fabs(vertex.m_texture_coordinates.x) > HALF_UV_LIMIT ||
+            std::fabs(vertex.m_texture_coordinates.y) > HALF_UV_LIMIT) {
+            return requested == VertexFormat::Packed ? VertexFormat::PackedWideUv : VertexFormat::PackedTangentWideUv;
+        }
+    }
+    return requested;
+}
+
+inline bool hasTangent(VertexFormat format) {
+    return format != VertexFormat::Packed && format != VertexFormat::PackedWideUv;
+}
+
+struct PackedVertex {
+    glm::vec3 m_position;
+    uint32_t m_normal;
+    uint16_t m_texture_coordinates[2];
+};
+
+struct PackedTangentVertex {
+    glm::vec3 m_position;
+    uint32_t m_normal;
+    uint16_t m_texture_coordinates[2];
+    uint32_t m_tangent;
+};
+
+struct PackedWideUvVertex {
+    glm::vec3 m_position;
+    uint32_t m_normal;
+    glm::vec2 m_texture_coordinates;
+};
+
+struct PackedTangentWideUvVertex {
+    glm::vec3 m_position;
+    uint32_t m_normal;
+    glm::vec2 m_texture_coordinates;
+    uint32_t m_tangent;
+};
+
+static_assert(sizeof(PackedVertex) == 20, "PackedVertex mora biti bez dopune");
+static_assert(sizeof(PackedTangentVertex) == 24, "PackedTangentVertex mora biti bez dopune");
+static_assert(sizeof(PackedWideUvVertex) == 24, "PackedWideUvVertex mora biti bez dopune");
+static_assert(sizeof(PackedTangentWideUvVertex) == 28, "PackedTangentWideUvVertex mora biti bez dopune");
+
+//opis rasporeda u memoriji i konverzija iz punog verteksa, za svaki format u vreme kompajliranja
+template <typename V>
+struct VertexLayout;
+
+template <>
+struct VertexLayout<Vertex> {
+    static constexpr std::array<VertexAttribute, 5> attributes() {
+        return {{
+            {0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_position)},
+            {1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_normal)},
+            {2, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_texture_coordinates)},
+            {3, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_tangent)},
+            {4, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_bitangent)}
+        }};
+    }
+
+    static Vertex convert(const Vertex& vertex) {
+        return vertex;
+    }
+
+    static glm::vec2 textureCoordinates(const Vertex& vertex) {
+        return vertex.m_texture_coordinates;
+    }
+};
+
+inline uint32_t packNormal(const glm::vec3& normal, float w = 0.0f) {
+    return glm::packSnorm3x10_1x2(glm::vec4(normal, w));
+}
+
+//znak bitangente u odnosu na cross(normal, tangent), za w komponentu pakovane tangente
+inline uint32_t packTangent(const Vertex& vertex) {
+    float handedness = glm::dot(glm::cross(vertex.m_normal, vertex.m_tangent), vertex.m_bitangent) < 0.0f ? -1.0f : 1.0f;
+    return packNormal(vertex.m_tangent, handedness);
+}
+
+inline glm::vec2 unpackHalfUv(const uint16_t texture_coordinates[2]) {
+    return glm::vec2(glm::unpackHalf1x16(texture_coordinates[0]), glm::unpackHalf1x16(texture_coordinates[1]));
+}
+
+template <>
+struct VertexLayout<PackedVertex> {
+    static constexpr std::array<VertexAttribute, 3> attributes() {
+        return {{
+            {0, 3, GL_FLOAT, GL_FALSE, offsetof(PackedVertex, m_position)},
+            {1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedVertex, m_normal)},
+            {2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, m_texture_coordinates)}
+        }};
+    }
+
+    static PackedVertex convert(const Vertex& vertex) {
+        PackedVertex packed;
+        packed.m_position = vertex.m_position;
+        packed.m_normal = packNormal(vertex.m_normal);
+        packed.m_texture_coordinates[0] = glm::packHalf1x16(vertex.m_texture_coordinates.x);
+        packed.m_texture_coordinates[1] = glm::packHalf1x16(vertex.m_texture_coordinates.y);
+        return packed;
+    }
+
+    static glm::vec2 textureCoordinates(const PackedVertex& vertex) {
+        return unpackHalfUv(vertex.m_texture_coordinates);
+    }
+};
+
+template <>
+struct VertexLayout<PackedTangentVertex> {
+    static constexpr std::array<VertexAttribute, 4> attributes() {
+        return {{
+            {0, 3, GL_FLOAT, GL_FALSE, offsetof(PackedTangentVertex, m_position)},
+            {1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedTangentVertex, m_normal)},
+            {2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedTangentVertex, m_texture_coordinates)},
+            {3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedTangentVertex, m_tangent)}
+        }};
+    }
+
+    //bitangenta se u shader-u racuna kao cross(normal, tangent.xyz) * tangent.w
+    static PackedTangentVertex convert(const Vertex& vertex) {
+        PackedTangentVertex packed;
+        packed.m_position = vertex.m_position;
+        packed.m_normal = packNormal(vertex.m_normal);
+        packed.m_texture_coordinates[0] = glm::packHalf1x16(vertex.m_texture_coordinates.x);
+        packed.m_texture_coordinates[1] = glm::packHalf1x16(vertex.m_texture_coordinates.y);
+        packed.m_tangent = packTangent(vertex);
+        return packed;
+    }
+
+    static glm::vec2 textureCoordinates(const PackedTangentVertex& vertex) {
+        return unpackHalfUv(vertex.m_texture_coordinates);
+    }
+};
+
+template <>
+struct VertexLayout<PackedWideUvVertex> {
+    static constexpr std::array<VertexAttribute, 3> attributes() {
+        return {{
+            {0, 3, GL_FLOAT, GL_FALSE, offsetof(PackedWideUvVertex, m_position)},
+            {1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedWideUvVertex, m_normal)},
+            {2, 2, GL_FLOAT, GL_FALSE, offsetof(PackedWideUvVertex, m_texture_coordinates)}
+        }};
+    }
+
+    static PackedWideUvVertex convert(const Vertex& vertex) {
+        PackedWideUvVertex packed;
+        packed.m_position = vertex.m_position;
+        packed.m_normal = packNormal(vertex.m_normal);
+        packed.m_texture_coordinates = vertex.m_texture_coordinates;
+        return packed;
+    }
+
+    static glm::vec2 textureCoordinates(const PackedWideUvVertex& vertex) {
+        return vertex.m_texture_coordinates;
+    }
+};
+
+template <>
+struct VertexLayout<PackedTangentWideUvVertex> {
+    static constexpr std::array<VertexAttribute, 4> attributes() {
+        return {{
+            {0, 3, GL_FLOAT, GL_FALSE, offsetof(PackedTangentWideUvVertex, m_position)},
+            {1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedTangentWideUvVertex, m_normal)},
+            {2, 2, GL_FLOAT, GL_FALSE, offsetof(PackedTangentWideUvVertex, m_texture_coordinates)},
+            {3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedTangentWideUvVertex, m_tangent)}
+        }};
+    }
+
+    static PackedTangentWideUvVertex convert(const Vertex& vertex) {
+        PackedTangentWideUvVertex packed;
+        packed.m_position = vertex.m_position;
+        packed.m_normal = packNormal(vertex.m_normal);
+        packed.m_texture_coordinates = vertex.m_texture_coordinates;
+        packed.m_tangent = packTangent(vertex);
+        return packed;
+    }
+
+    static glm::vec2 textureCoordinates(const PackedTangentWideUvVertex& vertex) {
+        return vertex.m_texture_coordinates;
+    }
+};
+
+//najveca apsolutna greska UV koordinata posle pakovanja u format V i raspakivanja
+template <typename V>
+float uvRoundTripError(const std::vector<Vertex>& vertices) {
+    float error = 0.0f;
+    for (const Vertex& vertex : vertices) {
+        glm::vec2 unpacked = VertexLayout<V>::textureCoordinates(VertexLayout<V>::convert(vertex));
+        error = std::max(error, std::max(std::fabs(unpacked.x - vertex.m_texture_coordinates.x),
+                                         std::fabs(unpacked.y - vertex.m_texture_coordinates.y)));
+    }
+    return error;
+}
+
+inline float uvRoundTripError(VertexFormat format, const std::vector<Vertex>& vertices) {
+    switch (format) {
+        case VertexFormat::Full:
+            return uvRoundTripError<Vertex>(vertices);
+        case VertexFormat::Packed:
+            return uvRoundTripError<PackedVertex>(vertices);
+        case VertexFormat::PackedTangent:
+            return uvRoundTripError<PackedTangentVertex>(vertices);
+        case VertexFormat::PackedWideUv:
+            return uvRoundTripError<PackedWideUvVertex>(vertices);
+        case VertexFormat::PackedTangentWideUv:
+            return uvRoundTripError<PackedTangentWideUvVertex>(vertices);
+    }
+    return 0.0f;
+}
+
+}
+
+#endif //PROJECT_BASE_VERTEXLAYOUT_H
@@ -0,0 +1,72 @@
+#version 330 core
+//prolaz osvetljenja odlozenog puta, preko celog ekrana uz aa_shader.vs
+//varijante: DIRECTIONAL_LIGHT, SPOT_LIGHT, CLUSTERED_LIGHTS kao u object.fs
+//G-buffer ima isti broj uzoraka kao MSAA framebuffer; piksel unutar jedne povrsi se osvetljava jednom,
+//a samo piksel na ivici (uzorci razlicite dubine ili normale) po uzorku
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+#include "include/frame_data.glsl"
+#include "include/lighting.glsl"
+#include "include/gbuffer.glsl"
+
+uniform sampler2DMS gAlbedoSpecular;
+uniform sampler2DMS gNormal;
+uniform sampler2DMS gDepth;
+uniform int sampleCount;
+uniform mat4 inverseViewProjection;
+
+vec3 ShadeSample(ivec2 pixel, int index, float depth)
+{
+    vec4 albedo_specular = texelFetch(gAlbedoSpecular, pixel, index);
+    MaterialSample surface;
+    surface.m_diffuse = albedo_specular.rgb;
+    surface.m_specular = vec3(albedo_specular.a);
+    surface.m_alpha = 1.0;
+    vec3 normal = DecodeNormal(texelFetch(gNormal, pixel, index).xy);
+
+    //polozaj u svetu iz dubine i koordinata na ekranu
+    vec4 position = inverseViewProjection * vec4(vec3(TexCoords, depth) * 2.0 - 1.0, 1.0);
+    vec3 fragment_position = position.xyz / position.w;
+    vec3 view_direction = normalize(cameraPosition.xyz - fragment_position);
+
+    vec3 result = vec3(0.0);
+#ifdef DIRECTIONAL_LIGHT
+    result += CalcDirLight(directional_light, normal, view_direction, surface);
+#endif
+#ifdef SPOT_LIGHT
+    result += CalcSpotLight(light, normal, view_direction, fragment_position, surface);
+#endif
+#ifdef CLUSTERED_LIGHTS
+    result += CalcClusteredLights(normal, view_direction, fragment_position, surface);
+#endif
+    return result;
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float first_depth = texelFetch(gDepth, pixel, 0).r;
+    vec2 first_normal = texelFetch(gNormal, pixel, 0).xy;
+    bool edge = false;
+    for (int i = 1; i < sampleCount; i++) {
+        edge = edge || texelFetch(gDepth, pixel, i).r != first_depth ||
+               any(greaterThan(abs(texelFetch(gNormal, pixel, i).xy - first_normal), vec2(0.01)));
+    }
+
+    //uzorci pozadine (dubina 1) ostaju skybox-u, koji se crta posle sa GL_LEQUAL
+    vec3 color = vec3(0.0);
+    int lit = 0;
+    int samples = edge ? sampleCount : 1;
+    for (int i = 0; i < samples; i++) {
+        float depth = i == 0 ? first_depth : texelFetch(gDepth, pixel, i).r;
+        if (depth < 1.0) {
+            color += ShadeSample(pixel, i, depth);
+            lit++;
+        }
+    }
+    if (lit == 0)
+        discard;
+    FragColor = vec4(color / float(lit), 1.0);
+}
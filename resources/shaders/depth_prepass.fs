@@ -0,0 +1,25 @@
+#version 330 core
+//prolaz samo dubine, ide uz object.vs; varijanta ALPHA_TEST cita samo alfu difuzne teksture,
+//uz ALPHA_TO_COVERAGE je predaje kao pokrivenost uzoraka umesto odbacivanja (boja se ne pise)
+//posle njega se scena crta sa GL_EQUAL bez alfa testa, pa skupo osvetljenje radi jednom po vidljivom uzorku
+//izlaz boje postoji u svakoj varijanti: alpha-to-coverage je ukljucen za ceo prolaz, pa neprovidni objekti
+//moraju dati alfu 1 da bi pokrili sve uzorke
+in vec2 TexCoords;
+
+#ifdef ALPHA_TEST
+#include "include/material.glsl"
+#endif
+out vec4 FragColor;
+
+void main()
+{
+#if defined(ALPHA_TEST) && defined(ALPHA_TO_COVERAGE)
+    FragColor = vec4(0.0, 0.0, 0.0, coverageAlpha(texture(material.texture_diffuse1, TexCoords).a));
+#elif defined(ALPHA_TEST)
+    if (texture(material.texture_diffuse1, TexCoords).a < ALPHA_CUTOFF)
+        discard;
+    FragColor = vec4(1.0);
+#else
+    FragColor = vec4(1.0);
+#endif
+}
@@ -0,0 +1,40 @@
+#version 330 core
+//geometrijski prolaz odlozenog osvetljenja, ide uz object.vs; varijante ALPHA_TEST, ALPHA_TO_COVERAGE i NORMAL_MAP
+//kao u object.fs; svetla se racunaju tek u deferred_lighting.fs
+//alpha-to-coverage cita alfu izlaza 0, pa je normala prva: njen cetvrti kanal ne postoji u RG16F i nosi pokrivenost
+layout (location = 0) out vec4 gNormal;
+layout (location = 1) out vec4 gAlbedoSpecular;
+
+in vec2 TexCoords;
+in vec3 Normal;
+in vec3 FragPos;
+#ifdef NORMAL_MAP
+in vec3 Tangent;
+in vec3 Bitangent;
+#endif
+
+#include "include/material.glsl"
+#include "include/gbuffer.glsl"
+
+void main()
+{
+    MaterialSample surface = sampleMaterial(TexCoords);
+#if defined(ALPHA_TEST) && !defined(ALPHA_TO_COVERAGE)
+    if (surface.m_alpha < ALPHA_CUTOFF)
+        discard;
+#endif
+
+#ifdef NORMAL_MAP
+    vec3 normal = sampleNormal(TexCoords, normalize(Normal), Tangent, Bitangent);
+#else
+    vec3 normal = normalize(Normal);
+#endif
+
+    //spekularna mapa je jednokanalna (sampleMaterial je siri na xxx)
+    gAlbedoSpecular = vec4(surface.m_diffuse, surface.m_specular.x);
+#if defined(ALPHA_TEST) && defined(ALPHA_TO_COVERAGE)
+    gNormal = vec4(EncodeNormal(normal), 0.0, coverageAlpha(surface.m_alpha));
+#else
+    gNormal = vec4(EncodeNormal(normal), 0.0, 1.0);
+#endif
+}
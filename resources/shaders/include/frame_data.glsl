@@ -0,0 +1,7 @@
+//isti raspored kao rg::FrameData
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec4 cameraPosition;
+    float time;
+};
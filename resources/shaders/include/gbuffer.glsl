@@ -0,0 +1,23 @@
+//raspored G-buffer-a: RGBA8 difuzna boja i intenzitet spekularne komponente, RG16F normala u oktaedarskom zapisu
+
+//normala se projektuje na oktaedar |x| + |y| + |z| = 1, donja polovina se preklapa preko gornje,
+//pa dve komponente nose ceo pravac sa skoro ravnomernom preciznoscu
+vec2 OctahedronWrap(vec2 v)
+{
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec2 EncodeNormal(vec3 normal)
+{
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+    return normal.z >= 0.0 ? normal.xy : OctahedronWrap(normal.xy);
+}
+
+vec3 DecodeNormal(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = clamp(-normal.z, 0.0, 1.0);
+    normal.x += normal.x >= 0.0 ? -fold : fold;
+    normal.y += normal.y >= 0.0 ? -fold : fold;
+    return normalize(normal);
+}
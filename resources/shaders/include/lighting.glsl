@@ -0,0 +1,144 @@
+#include "material.glsl"
+
+struct DirLight {
+    vec3 m_direction;
+    vec3 m_ambient;
+    vec3 m_diffuse;
+    vec3 m_specular;
+};
+
+struct SpotLight {
+    vec3 m_position;
+    vec3 m_direction;
+    float m_cutOff;
+    float m_outerCutOff;
+
+    vec3 m_ambient;
+    vec3 m_diffuse;
+    vec3 m_specular;
+
+    float m_constant;
+    float m_linear;
+    float m_quadratic;
+};
+
+struct PointLight {
+    vec3 m_position;
+
+    vec3 m_ambient;
+    vec3 m_diffuse;
+    vec3 m_specular;
+
+    float m_constant;
+    float m_linear;
+    float m_quadratic;
+};
+
+//isti raspored kao rg::LightData
+layout (std140) uniform LightData {
+    DirLight directional_light;
+    SpotLight light;
+};
+
+#ifdef POINT_LIGHT
+uniform PointLight pointLight;
+#endif
+
+//Blinn-Phong za svetlo iz pravca light_direction (ka svetlu), bez slabljenja
+vec3 BlinnPhong(vec3 ambient, vec3 diffuse, vec3 specular, vec3 light_direction, vec3 normal, vec3 view_direction,
+                MaterialSample surface)
+{
+    float diff = max(dot(normal, light_direction), 0.0);
+    vec3 halfway_direction = normalize(light_direction + view_direction);
+    float spec = pow(max(dot(normal, halfway_direction), 0.0), material.m_shininess);
+
+    return ambient * surface.m_diffuse + diffuse * diff * surface.m_diffuse + specular * spec * surface.m_specular;
+}
+
+float Attenuation(float constant, float linear, float quadratic, float distance)
+{
+    return 1.0 / (constant + linear * distance + quadratic * (distance * distance));
+}
+
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 view_direction, MaterialSample surface)
+{
+    return BlinnPhong(light.m_ambient, light.m_diffuse, light.m_specular, normalize(-light.m_direction), normal,
+                      view_direction, surface);
+}
+
+//ambijentalni deo ne zavisi od kupe, slabljenje vazi za sve
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 view_direction, vec3 fragment_position, MaterialSample surface)
+{
+    vec3 light_direction = normalize(light.m_position - fragment_position);
+    float theta = dot(light_direction, normalize(-light.m_direction));
+    float epsilon = light.m_cutOff - light.m_outerCutOff;
+    float intensity = clamp((theta - light.m_outerCutOff) / epsilon, 0.0, 1.0);
+    float attenuation = Attenuation(light.m_constant, light.m_linear, light.m_quadratic,
+                                    length(light.m_position - fragment_position));
+
+    vec3 ambient = light.m_ambient * surface.m_diffuse;
+    vec3 lit = BlinnPhong(vec3(0.0), light.m_diffuse, light.m_specular, light_direction, normal, view_direction, surface);
+    return (ambient + lit * intensity) * attenuation;
+}
+
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 view_direction, vec3 fragment_position, MaterialSample surface)
+{
+    vec3 light_direction = normalize(light.m_position - fragment_position);
+    float attenuation = Attenuation(light.m_constant, light.m_linear, light.m_quadratic,
+                                    length(light.m_position - fragment_position));
+    return BlinnPhong(light.m_ambient, light.m_diffuse, light.m_specular, light_direction, normal, view_direction,
+                      surface) * attenuation;
+}
+
+#ifdef CLUSTERED_LIGHTS
+//isti raspored kao rg::ClusterData
+layout (std140) uniform ClusterData {
+    uvec4 clusterGrid;  // broj klastera po x, y i z, broj svetala
+    vec4 clusterDepth;  // skala i pomeraj logaritma dubine za indeks preseka, velicina plocice u pikselima
+};
+
+//tri teksela po svetlu: pozicija i domet, boja i kosinus unutrasnje kupe, pravac i kosinus spoljasnje kupe
+uniform samplerBuffer clusterLights;
+//pocetak i duzina liste svetala klastera
+uniform usamplerBuffer clusterRanges;
+uniform usamplerBuffer clusterIndices;
+
+//slabljenje sa kvadratom rastojanja, pomnozeno prozorom koji ga glatko spusta na nulu na dometu,
+//pa svetlo nema vidljivu ivicu na granici klastera u kojima vise nije u listi
+float RangeAttenuation(float distance, float range)
+{
+    float ratio = distance / range;
+    float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return window * window / (1.0 + distance * distance);
+}
+
+//zbir svih svetala iz klastera fragmenta; klaster se odredjuje iz polozaja na ekranu i dubine u prostoru kamere
+vec3 CalcClusteredLights(vec3 normal, vec3 view_direction, vec3 fragment_position, MaterialSample surface)
+{
+    float depth = -(view * vec4(fragment_position, 1.0)).z;
+    uint slice = uint(max(log(depth) * clusterDepth.x + clusterDepth.y, 0.0));
+    uvec3 cluster = min(uvec3(uvec2(gl_FragCoord.xy / clusterDepth.zw), slice), clusterGrid.xyz - 1u);
+    uvec2 range = texelFetch(clusterRanges, int(cluster.x + clusterGrid.x * (cluster.y + clusterGrid.y * cluster.z))).xy;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < range.y; i++) {
+        int light = int(texelFetch(clusterIndices, int(range.x + i)).x) * 3;
+        vec4 position_range = texelFetch(clusterLights, light);
+        vec4 color_inner = texelFetch(clusterLights, light + 1);
+        vec4 direction_outer = texelFetch(clusterLights, light + 2);
+
+        vec3 to_light = position_range.xyz - fragment_position;
+        float distance = max(length(to_light), 0.0001);
+        vec3 light_direction = to_light / distance;
+        //tackasto svetlo ima kosinuse kupe manje od -1, pa je intenzitet uvek 1
+        float theta = dot(light_direction, -direction_outer.xyz);
+        float intensity = clamp((theta - direction_outer.w) / (color_inner.w - direction_outer.w), 0.0, 1.0);
+        float attenuation = RangeAttenuation(distance, position_range.w) * intensity;
+        if (attenuation > 0.0) {
+            result += BlinnPhong(vec3(0.0), color_inner.rgb, color_inner.rgb, light_direction, normal, view_direction,
+                                 surface) * attenuation;
+        }
+    }
+    return result;
+}
+#endif
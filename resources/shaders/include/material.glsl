@@ -0,0 +1,50 @@
+//materijal mesh-a; sampler-i se vezuju preko prefiksa imena iz Mesh::SetTextureNamePrefix
+struct Material {
+    sampler2D texture_diffuse1;
+    sampler2D texture_specular1;
+#ifdef NORMAL_MAP
+    sampler2D texture_normal1;
+#endif
+    float m_shininess;
+};
+
+uniform Material material;
+
+//fragmenti providniji od ovoga se odbacuju u varijanti sa ALPHA_TEST; isto kao rg::ALPHA_TEST_CUTOFF
+const float ALPHA_CUTOFF = 0.8;
+
+#ifdef ALPHA_TO_COVERAGE
+//alfa za GL_SAMPLE_ALPHA_TO_COVERAGE umesto odbacivanja: prelaz oko ALPHA_CUTOFF se suzava na oko jedan piksel,
+//pa ivica lista ostaje ostra kao sa alfa testom, ali je pokriva deo uzoraka MSAA piksela
+float coverageAlpha(float alpha)
+{
+    return clamp((alpha - ALPHA_CUTOFF) / max(fwidth(alpha), 0.0001) + 0.5, 0.0, 1.0);
+}
+#endif
+
+//teksture materijala se citaju jednom po fragmentu, bez obzira na broj svetala
+struct MaterialSample {
+    vec3 m_diffuse;
+    vec3 m_specular;
+    float m_alpha;
+};
+
+MaterialSample sampleMaterial(vec2 texture_coordinates)
+{
+    MaterialSample surface;
+    vec4 diffuse = texture(material.texture_diffuse1, texture_coordinates);
+    surface.m_diffuse = diffuse.rgb;
+    surface.m_alpha = diffuse.a;
+    surface.m_specular = texture(material.texture_specular1, texture_coordinates).xxx;
+    return surface;
+}
+
+#ifdef NORMAL_MAP
+//normalna mapa je u dva kanala (BC5), z se racuna iz x i y
+vec3 sampleNormal(vec2 texture_coordinates, vec3 normal, vec3 tangent, vec3 bitangent)
+{
+    vec2 xy = texture(material.texture_normal1, texture_coordinates).rg * 2.0 - 1.0;
+    vec3 local = vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0)));
+    return normalize(mat3(normalize(tangent), normalize(bitangent), normal) * local);
+}
+#endif
@@ -0,0 +1,53 @@
+#version 330 core
+//varijante: DIRECTIONAL_LIGHT, SPOT_LIGHT, POINT_LIGHT - svetla koja se racunaju (moze ih biti vise),
+//CLUSTERED_LIGHTS - svetla iz klastera fragmenta (rg::ClusteredLights),
+//ALPHA_TEST - odbacivanje providnih fragmenata, uz ALPHA_TO_COVERAGE umesto toga alfa za pokrivenost uzoraka,
+//NORMAL_MAP - normala iz normalne mape
+out vec4 FragColor;
+
+in vec2 TexCoords;
+in vec3 Normal;
+in vec3 FragPos;
+#ifdef NORMAL_MAP
+in vec3 Tangent;
+in vec3 Bitangent;
+#endif
+
+#include "include/frame_data.glsl"
+#include "include/lighting.glsl"
+
+void main()
+{
+    MaterialSample surface = sampleMaterial(TexCoords);
+#if defined(ALPHA_TEST) && !defined(ALPHA_TO_COVERAGE)
+    //pre osvetljenja, da odbaceni fragmenti ne placaju racunanje svetla
+    if (surface.m_alpha < ALPHA_CUTOFF)
+        discard;
+#endif
+
+#ifdef NORMAL_MAP
+    vec3 normal = sampleNormal(TexCoords, normalize(Normal), Tangent, Bitangent);
+#else
+    vec3 normal = normalize(Normal);
+#endif
+    vec3 view_direction = normalize(cameraPosition.xyz - FragPos);
+
+    vec3 result = vec3(0.0);
+#ifdef DIRECTIONAL_LIGHT
+    result += CalcDirLight(directional_light, normal, view_direction, surface);
+#endif
+#ifdef SPOT_LIGHT
+    result += CalcSpotLight(light, normal, view_direction, FragPos, surface);
+#endif
+#ifdef POINT_LIGHT
+    result += CalcPointLight(pointLight, normal, view_direction, FragPos, surface);
+#endif
+#ifdef CLUSTERED_LIGHTS
+    result += CalcClusteredLights(normal, view_direction, FragPos, surface);
+#endif
+#if defined(ALPHA_TEST) && defined(ALPHA_TO_COVERAGE)
+    FragColor = vec4(result, coverageAlpha(surface.m_alpha));
+#else
+    FragColor = vec4(result, 1.0);
+#endif
+}
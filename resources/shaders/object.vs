@@ -0,0 +1,48 @@
+#version 330 core
+//varijante: INSTANCED - model matrica iz atributa instance (i za indirektno crtanje),
+//NORMAL_MAP - tangenta iz PackedTangent formata za normalne mape
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+#ifdef NORMAL_MAP
+layout (location = 3) in vec4 aTangent;
+#endif
+#ifdef INSTANCED
+layout (location = 5) in mat4 aModel;
+#else
+uniform mat4 model;
+#endif
+
+#include "include/frame_data.glsl"
+
+//prolaz samo dubine i prolaz osvetljenja sa GL_EQUAL koriste razlicite programe, pa pozicija mora biti ista bit za bit
+invariant gl_Position;
+
+out vec2 TexCoords;
+out vec3 Normal;
+out vec3 FragPos;
+#ifdef NORMAL_MAP
+out vec3 Tangent;
+out vec3 Bitangent;
+#endif
+
+void main()
+{
+#ifdef INSTANCED
+    mat4 modelMatrix = aModel;
+#else
+    mat4 modelMatrix = model;
+#endif
+    FragPos = vec3(modelMatrix * vec4(aPos, 1.0));
+
+    mat3 normalMatrix = transpose(inverse(mat3(modelMatrix)));
+    Normal = normalize(normalMatrix * aNormal);
+#ifdef NORMAL_MAP
+    //w je znak bitangente; Full format nema w, pa je 1
+    Tangent = normalize(mat3(modelMatrix) * aTangent.xyz);
+    Bitangent = cross(Normal, Tangent) * aTangent.w;
+#endif
+
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
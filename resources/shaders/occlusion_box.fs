@@ -0,0 +1,8 @@
+#version 330 core
+//upis boje je iskljucen, upit broji samo uzorke koji prodju test dubine
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(1.0);
+}
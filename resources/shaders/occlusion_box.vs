@@ -0,0 +1,13 @@
+#version 330 core
+//granicni kvadar objekta za upit zaklonjenosti; jedinicna kocka se razvlaci od boxMin do boxMax u svetu
+layout (location = 0) in vec3 aPos;
+
+#include "include/frame_data.glsl"
+
+uniform vec3 boxMin;
+uniform vec3 boxMax;
+
+void main()
+{
+    gl_Position = projection * view * vec4(mix(boxMin, boxMax, aPos), 1.0);
+}
@@ -13,8 +13,25 @@
 #include <rg/Shader.h>
 #include <rg/Camera.h>
 #include <rg/Model.h>
-
+#include <rg/Image.h>
+#include <rg/Lod.h>
+#include <rg/Bvh.h>
+#include <rg/ClusteredLights.h>
+#include <rg/FrameStats.h>
+#include <rg/GeometryPool.h>
+#include <rg/Frustum.h>
+#include <rg/MultiDrawIndirect.h>
+#include <rg/OcclusionCulling.h>
+#include <rg/PassQueries.h>
+#include <rg/RenderQueue.h>
+#include <rg/ShaderVariants.h>
+#include <rg/UniformBuffer.h>
+#include <rg/TextureRegistry.h>
+
+#include <algorithm>
+#include <future>
 #include <iostream>
+#include <random>
 #include <vector>
 
 void frameBufferSizeCallBack(GLFWwindow *window, int width, int height);
@@ -27,12 +44,15 @@ void processInput(GLFWwindow *window);
 
 void keyCallBack(GLFWwindow *window, int key, int scancode, int action, int mods);
 
-unsigned int loadCubemap(std::vector<std::string> faces);
+unsigned int loadCubemap(const std::vector<std::shared_future<rg::Image>>& faces);
 
 //velicina prozora
 const unsigned int SRC_WIDTH = 1280;
 const unsigned int SRC_HEIGHT = 720;
 
+//broj uzoraka MSAA framebuffer-a i G-buffer-a
+const unsigned int MSAA_SAMPLES = 4;
+
 //kamera
 float lastX = SRC_WIDTH / 2.0f;
 float lastY = SRC_HEIGHT / 2.0f;
@@ -87,9 +107,53 @@ bool day = true;
 
 float nightVision = 0.0f;
 
+//izbor nivoa detalja modela po velicini na ekranu
+rg::LodSelector lodSelector;
+
+bool instancing = true;
+
+bool frustumCulling = true;
+
+//nocu se pored baterijske lampe racunaju i svetla scene kroz klastere
+bool clusteredLighting = true;
+
+//odlozeno osvetljenje: scena se crta u G-buffer, svetla se racunaju jednom po pikselu preko celog ekrana
+bool deferredShading = false;
+
+//prolaz samo dubine pre osvetljenja, koje zatim crta samo vidljive uzorke
+bool depthPrepass = false;
+
+//lisce: alfa postaje pokrivenost uzoraka MSAA framebuffer-a umesto odbacivanja fragmenata
+bool alphaToCoverage = true;
+
+//objekti ciji granicni kvadar nije prosao test dubine prethodnih frejmova se ne crtaju
+bool occlusionCulling = true;
+
+//pozivi crtanja scene se sortiraju po stanju pre slanja
+rg::RenderQueue renderQueue;
+
+//imena uniform-a koja se postavljaju svakog frejma, hesiraju se pri kompajliranju
+namespace uniforms {
+constexpr rg::UniformName PROJECTION("projection");
+constexpr rg::UniformName VIEW("view");
+constexpr rg::UniformName NIGHT_VISION("nightVision");
+constexpr rg::UniformName INVERSE_VIEW_PROJECTION("inverseViewProjection");
+}
+
+//glfwTerminate se poziva tek posle destruktora modela, koji jos brisu GL objekte
+//globalni GL objekti se brisu pre gasenja konteksta
+struct GlfwTerminator {
+    ~GlfwTerminator() {
+        renderQueue.release();
+        rg::GeometryPool::instance().release();
+        glfwTerminate();
+    }
+};
+
 int main() {
     //glfw: inicijalizacija i konfiguracija
     glfwInit();
+    GlfwTerminator glfwTerminator;
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_CORE_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -114,8 +178,34 @@ int main() {
         return -1;
     }
 
+    //3.3 je najmanja trazena verzija; drajveri obicno vrate noviji core kontekst, pa indirektni put moze da radi
+    std::cout << "OpenGL " << glGetString(GL_VERSION) << ", indirektno crtanje (GL 4.3+) "
+              << (rg::MultiDrawIndirect::isSupported() ? "podrzano" : "nije podrzano, koristi se GL 3.3 put") << "\n";
+
     //stbi_set_flip_vertically_on_load(true);
 
+    std::vector<std::string> day_faces{
+            "resources/cubemap/day/right.jpg",
+            "resources/cubemap/day/left.jpg",
+            "resources/cubemap/day/top.jpg",
+            "resources/cubemap/day/bottom.jpg",
+            "resources/cubemap/day/front.jpg",
+            "resources/cubemap/day/back.jpg"
+    };
+
+    std::vector<std::string> night_faces{
+            "resources/cubemap/night/left.jpg",
+            "resources/cubemap/night/left.jpg",
+            "resources/cubemap/night/left.jpg",
+            "resources/cubemap/night/left.jpg",
+            "resources/cubemap/night/left.jpg",
+            "resources/cubemap/night/left.jpg"
+    };
+
+    //dekodiranje strana cubemap-a pocinje odmah na radnim nitima, paralelno sa ucitavanjem modela
+    std::vector<std::shared_future<rg::Image>> dayFaceImages = rg::decodeImagesAsync(day_faces);
+    std::vector<std::shared_future<rg::Image>> nightFaceImages = rg::decodeImagesAsync(night_faces);
+
     //konfiguracija OpenGL-a
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
@@ -206,47 +296,61 @@ int main() {
     unsigned int textureColorBufferMultiSampled;
     glGenTextures(1, &textureColorBufferMultiSampled);
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, textureColorBufferMultiSampled);
-    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_RGB, SRC_WIDTH, SRC_HEIGHT, GL_TRUE);
+    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, MSAA_SAMPLES, GL_RGB, SRC_WIDTH, SRC_HEIGHT, GL_TRUE);
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, textureColorBufferMultiSampled, 0);
 
-    unsigned int rbo;
-    glGenRenderbuffers(1, &rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_DEPTH24_STENCIL8, SRC_WIDTH, SRC_HEIGHT);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
+    //dubina je tekstura umesto renderbuffer-a, jer je prolaz osvetljenja odlozenog puta cita
+    unsigned int depthStencilMultiSampled;
+    glGenTextures(1, &depthStencilMultiSampled);
+    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, depthStencilMultiSampled);
+    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, MSAA_SAMPLES, GL_DEPTH24_STENCIL8, SRC_WIDTH, SRC_HEIGHT, GL_TRUE);
+    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D_MULTISAMPLE, depthStencilMultiSampled, 0);
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::FRAMEBUFFER:: Framebuffer is not complete!" << "\n";
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    std::vector<std::string> day_faces{
-            "resources/cubemap/day/right.jpg",
-            "resources/cubemap/day/left.jpg",
-            "resources/cubemap/day/top.jpg",
-            "resources/cubemap/day/bottom.jpg",
-            "resources/cubemap/day/front.jpg",
-            "resources/cubemap/day/back.jpg"
-    };
-    unsigned int cubemapTextureDay = loadCubemap(day_faces);
+    //G-buffer: normala u dva kanala i difuzna boja sa spekularnim intenzitetom, sa istim brojem uzoraka i
+    //istom dubinom kao MSAA framebuffer, pa skybox posle prolaza osvetljenja radi kao na forward putu
+    //normala je prva jer alpha-to-coverage cita alfu izlaza 0, a alfa druge mete je spekularni intenzitet
+    unsigned int gBuffer;
+    glGenFramebuffers(1, &gBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+
+    unsigned int gAlbedoSpecular, gNormal;
+    glGenTextures(1, &gAlbedoSpecular);
+    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, gAlbedoSpecular);
+    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, MSAA_SAMPLES, GL_RGBA8, SRC_WIDTH, SRC_HEIGHT, GL_TRUE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D_MULTISAMPLE, gAlbedoSpecular, 0);
+    glGenTextures(1, &gNormal);
+    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, gNormal);
+    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, MSAA_SAMPLES, GL_RG16F, SRC_WIDTH, SRC_HEIGHT, GL_TRUE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, gNormal, 0);
+    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D_MULTISAMPLE, depthStencilMultiSampled, 0);
+    const GLenum gBufferAttachments[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, gBufferAttachments);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: G-buffer is not complete!" << "\n";
+
+    //prolaz osvetljenja cita dubinu, pa pise u isti MSAA bafer boje kroz framebuffer bez dubine
+    unsigned int lightingFramebuffer;
+    glGenFramebuffers(1, &lightingFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, lightingFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, textureColorBufferMultiSampled, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: Lighting framebuffer is not complete!" << "\n";
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    std::vector<std::string> night_faces{
-            "resources/cubemap/night/left.jpg",
-            "resources/cubemap/night/left.jpg",
-            "resources/cubemap/night/left.jpg",
-            "resources/cubemap/night/left.jpg",
-            "resources/cubemap/night/left.jpg",
-            "resources/cubemap/night/left.jpg"
-    };
-    unsigned int cubemapTextureNight = loadCubemap(night_faces);
 
 
     //kreiranje shader-a
-    Shader dirShader("resources/shaders/vertex_shader.vs", "resources/shaders/direction_light.fs");
     Shader skyboxShader("resources/shaders/skybox_shader.vs", "resources/shaders/skybox_shader.fs");
-    Shader spotShader("resources/shaders/vertex_shader.vs", "resources/shaders/spot_light.fs");
     Shader screenShader("resources/shaders/aa_shader.vs", "resources/shaders/aa_shader.fs");
+    Shader occlusionShader("resources/shaders/occlusion_box.vs", "resources/shaders/occlusion_box.fs");
 
     skyboxShader.use();
     skyboxShader.setInt("skybox", 0);
@@ -256,17 +360,84 @@ int main() {
     screenShader.setInt("width", SRC_WIDTH);
     screenShader.setInt("height", SRC_HEIGHT);
 
+    //svetla, instanciranje, alfa test i normalne mape su define-ovi jednog para shader-a
+    //sjajnost je ista za sve materijale scene, postavlja se jednom po varijanti, kao i jedinice bafera svetala
+    rg::ShaderVariants objectShaders("resources/shaders/object.vs", "resources/shaders/object.fs", [](Shader &shader) {
+        shader.use();
+        shader.setFloat("material.m_shininess", 32.0f);
+        rg::ClusteredLights::setSamplers(shader);
+    });
+    //varijante koje scena sigurno koristi prave se odmah, da prelazak na noc ne bi cekao kompajliranje
+    for (uint32_t light : {(uint32_t) rg::SHADER_DIRECTIONAL_LIGHT, (uint32_t) rg::SHADER_SPOT_LIGHT,
+                           (uint32_t) (rg::SHADER_SPOT_LIGHT | rg::SHADER_CLUSTERED_LIGHTS)}) {
+        for (uint32_t instanced : {0u, (uint32_t) rg::SHADER_INSTANCED}) {
+            for (uint32_t alpha : {0u, (uint32_t) rg::SHADER_ALPHA_TEST, (uint32_t) (rg::SHADER_ALPHA_TEST | rg::SHADER_ALPHA_TO_COVERAGE)}) {
+                objectShaders.get(light | instanced | alpha);
+            }
+        }
+    }
+    objectShaders.printStats(std::cout);
+
+    //odlozeni put: geometrijski prolaz nema svetla, prolaz osvetljenja ima iste svetlosne varijante kao object.fs
+    rg::ShaderVariants gBufferShaders("resources/shaders/object.vs", "resources/shaders/gbuffer.fs");
+    rg::ShaderVariants deferredLightingShaders("resources/shaders/aa_shader.vs", "resources/shaders/deferred_lighting.fs", [](Shader &shader) {
+        shader.use();
+        shader.setFloat("material.m_shininess", 32.0f);
+        shader.setInt("gAlbedoSpecular", 10);
+        shader.setInt("gNormal", 11);
+        shader.setInt("gDepth", 12);
+        shader.setInt("sampleCount", MSAA_SAMPLES);
+        rg::ClusteredLights::setSamplers(shader);
+    });
+    for (uint32_t instanced : {0u, (uint32_t) rg::SHADER_INSTANCED}) {
+        for (uint32_t alpha : {0u, (uint32_t) rg::SHADER_ALPHA_TEST, (uint32_t) (rg::SHADER_ALPHA_TEST | rg::SHADER_ALPHA_TO_COVERAGE)}) {
+            gBufferShaders.get(instanced | alpha);
+        }
+    }
+    for (uint32_t light : {(uint32_t) rg::SHADER_DIRECTIONAL_LIGHT, (uint32_t) rg::SHADER_SPOT_LIGHT,
+                           (uint32_t) (rg::SHADER_SPOT_LIGHT | rg::SHADER_CLUSTERED_LIGHTS)}) {
+        deferredLightingShaders.get(light);
+    }
+    //prolaz samo dubine crta pakete prolaza osvetljenja sa istim osobinama; normalna mapa i svetla ne menjaju
+    //dubinu, pa se zanemaruju
+    rg::ShaderVariants depthShaders("resources/shaders/object.vs", "resources/shaders/depth_prepass.fs");
+    depthShaders.setIgnoredFeatures(rg::SHADER_NORMAL_MAP | rg::SHADER_DIRECTIONAL_LIGHT | rg::SHADER_SPOT_LIGHT |
+                                    rg::SHADER_POINT_LIGHT | rg::SHADER_CLUSTERED_LIGHTS);
+    for (uint32_t instanced : {0u, (uint32_t) rg::SHADER_INSTANCED}) {
+        for (uint32_t alpha : {0u, (uint32_t) rg::SHADER_ALPHA_TEST, (uint32_t) (rg::SHADER_ALPHA_TEST | rg::SHADER_ALPHA_TO_COVERAGE)}) {
+            depthShaders.get(instanced | alpha);
+        }
+    }
+    gBufferShaders.printStats(std::cout);
+    deferredLightingShaders.printStats(std::cout);
+    depthShaders.printStats(std::cout);
+
+    //GPU vreme i broj uzoraka koji prodju test dubine po prolazu, za poredjenje puteva i merenje preklapanja
+    rg::PassQueries gpuTimer(GL_TIME_ELAPSED);
+    rg::PassQueries sampleCounter(GL_SAMPLES_PASSED);
+
+    //kamera i svetla su zajednicki za sve programe, nalaze se u uniform buffer-ima
+    rg::UniformBuffer<rg::FrameData> frameUniforms(rg::FRAME_BLOCK_BINDING);
+    rg::UniformBuffer<rg::LightData> lightUniforms(rg::LIGHT_BLOCK_BINDING);
+    rg::ClusteredLights clusteredLights;
+    rg::OcclusionCulling occlusion;
+
 
-    //ucitavanje modela
-    Model ourModel("resources/objects/grass/Plane.obj");
+    //ucitavanje modela u pozadini, do tada se crtaju placeholder-i
+    Model ourModel("resources/objects/grass/Plane.obj", ModelLoading::Async);
     ourModel.SetShaderTextureNamePrefix("material.");
 
-    Model ourModel2("resources/objects/tree/Tree.obj");
+    Model ourModel2("resources/objects/tree/Tree.obj", ModelLoading::Async);
     ourModel2.SetShaderTextureNamePrefix("material1.");
 
-    Model ourModel3("resources/objects/hut/dom 1.obj");
+    Model ourModel3("resources/objects/hut/dom 1.obj", ModelLoading::Async);
     ourModel3.SetShaderTextureNamePrefix("material2.");
 
+    unsigned int cubemapTextureDay = loadCubemap(dayFaceImages);
+    unsigned int cubemapTextureNight = loadCubemap(nightFaceImages);
+    dayFaceImages.clear();
+    nightFaceImages.clear();
+
     dirLight.mDirection = glm::vec3(-0.0, -1.0f, 1.0f);
     dirLight.mAmbient = glm::vec3(0.1f, 0.1f, 0.1f);
     dirLight.mDiffuse = glm::vec3(0.8f, 0.8f, 0.8f);
@@ -291,6 +462,75 @@ int main() {
         floats.at(i) = ((float) random()/2147483646) * 2 - 1;
     }
 
+    //drvece se ne pomera, pa se model matrice racunaju jednom
+    std::vector<glm::mat4> treeModels;
+    for (unsigned int i = 0; i < 60; i++) {
+        float f = floats.at(i) * 60;
+        glm::mat4 model2 = glm::mat4(1.0f);
+        glm::vec3 pos = glm::vec3(glm::sin(glm::radians((float) i * 6))*f, 0.0f, glm::cos(glm::radians((float) i * 6))*f);
+        model2 = glm::translate(model2, pos);
+        model2 = glm::scale(model2, glm::vec3(1.0f));
+        treeModels.push_back(model2);
+    }
+
+    //svetla nocne scene razbacana medju drvecem: dve trecine tackastih, trecina reflektora usmerenih nadole
+    //svako kruzi oko svoje pocetne tacke, pa se raspodela po klasterima menja svakog frejma
+    const unsigned int NIGHT_LIGHT_COUNT = 500;
+    std::mt19937 lightRandom(7);
+    std::uniform_real_distribution<float> unitRandom(0.0f, 1.0f);
+    std::vector<rg::ClusterLight> nightLights;
+    std::vector<glm::vec3> nightLightOrigins;
+    for (unsigned int i = 0; i < NIGHT_LIGHT_COUNT; i++) {
+        glm::vec3 origin(unitRandom(lightRandom) * 120.0f - 60.0f, unitRandom(lightRandom) * 6.0f - 4.5f,
+                         unitRandom(lightRandom) * 120.0f - 60.0f);
+        glm::vec3 color = (glm::vec3(0.3f) + glm::vec3(unitRandom(lightRandom), unitRandom(lightRandom), unitRandom(lightRandom)) * 0.7f) * 4.0f;
+        float radius = 4.0f + unitRandom(lightRandom) * 4.0f;
+        if (i % 3 == 2) {
+            nightLights.push_back(rg::ClusterLight::spot(origin, glm::vec3(0.0f, -1.0f, 0.0f), radius * 1.5f, color, 20.0f, 30.0f));
+        }
+        else {
+            nightLights.push_back(rg::ClusterLight::point(origin, radius, color));
+        }
+        nightLightOrigins.push_back(origin);
+    }
+
+    //tlo i dve kuce
+    glm::mat4 groundModel = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -5.4f, 0.0f));
+    //groundModel = glm::rotate(groundModel, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    groundModel = glm::scale(groundModel, glm::vec3(3.0f));
+
+    glm::mat4 hutModel1 = glm::translate(glm::mat4(1.0f), glm::vec3(2.0f, 1.1f, 15.0f));
+    hutModel1 = glm::rotate(hutModel1, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    hutModel1 = glm::scale(hutModel1, glm::vec3(0.8f));
+
+    glm::mat4 hutModel2 = glm::translate(glm::mat4(1.0f), glm::vec3(-10.0f, 1.1f, 1.0f));
+    //hutModel2 = glm::rotate(hutModel2, glm::radians(-110.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    hutModel2 = glm::scale(hutModel2, glm::vec3(0.8f));
+
+    //sve instance scene; BVH nad njima se gradi kad su granice svih modela poznate
+    struct SceneObject {
+        Model *m_model;
+        glm::mat4 m_transform;
+    };
+    std::vector<SceneObject> sceneObjects;
+    for (const glm::mat4& treeModel : treeModels) {
+        sceneObjects.push_back({&ourModel2, treeModel});
+    }
+    sceneObjects.push_back({&ourModel, groundModel});
+    sceneObjects.push_back({&ourModel3, hutModel1});
+    sceneObjects.push_back({&ourModel3, hutModel2});
+
+    rg::Bvh sceneBvh;
+    std::vector<uint8_t> sceneVisible(sceneObjects.size(), 1);
+    //objekti koji se salju posle upita zaklonjenosti i upiti koji uslovljavaju njihovo crtanje
+    std::vector<uint8_t> sceneDrawn(sceneObjects.size(), 1);
+    std::vector<unsigned int> sceneConditions(sceneObjects.size(), 0);
+    std::vector<glm::mat4> visibleTrees;
+    std::vector<unsigned int> visibleTreeConditions;
+
+    bool firstFrame = true;
+    bool modelsResident = false;
+
     //petlja za renderovanje
     while (!glfwWindowShouldClose(window)) {
 
@@ -301,6 +541,24 @@ int main() {
         //ulazi
         processInput(window);
 
+        //slanje na GPU delova modela koji su ucitani u pozadini
+        ourModel.Update();
+        ourModel2.Update();
+        ourModel3.Update();
+
+        if (!modelsResident && ourModel.IsResident() && ourModel2.IsResident() && ourModel3.IsResident()) {
+            rg::TextureRegistry::instance().printStats(std::cout);
+            rg::GeometryPool::instance().printStats(std::cout);
+            modelsResident = true;
+
+            std::vector<rg::AABB> sceneBounds;
+            for (const SceneObject& object : sceneObjects) {
+                sceneBounds.push_back(object.m_model->m_bounds.transformed(object.m_transform));
+            }
+            sceneBvh.build(sceneBounds);
+            occlusion.setObjects(sceneBounds);
+        }
+
         //render
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -310,90 +568,208 @@ int main() {
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glEnable(GL_DEPTH_TEST);
 
-        Shader *tmpShader;
+        bool clustered = !day && clusteredLighting;
+        uint32_t lightFeatures = day ? rg::SHADER_DIRECTIONAL_LIGHT : rg::SHADER_SPOT_LIGHT;
+        if (clustered) {
+            lightFeatures |= rg::SHADER_CLUSTERED_LIGHTS;
+        }
+        //na odlozenom putu geometrijski prolaz ne zna za svetla
+        rg::ShaderVariants &sceneShaders = deferredShading ? gBufferShaders : objectShaders;
+        uint32_t surfaceFeatures = deferredShading ? 0u : lightFeatures;
+        uint32_t coverageFeatures = alphaToCoverage ? (uint32_t) rg::SHADER_ALPHA_TO_COVERAGE : 0u;
+        surfaceFeatures |= coverageFeatures;
 
-        if (day) {
-            dirShader.use();
-            dirShader.setVec3("directional_light.m_direction", dirLight.mDirection);
-            dirShader.setVec3("directional_light.m_ambient", dirLight.mAmbient);
-            dirShader.setVec3("directional_light.m_diffuse", dirLight.mDiffuse);
-            dirShader.setVec3("directional_light.m_specular", dirLight.mSpecular);
-            dirShader.setVec3("viewPosition", camera.m_position);
-            dirShader.setFloat("material.m_shininess", 32.0f);
-            tmpShader = &dirShader;
+        glm::mat4 projection = glm::perspective(glm::radians(camera.m_zoom),
+                                                (float) SRC_WIDTH / (float) SRC_HEIGHT, 0.1f, 100.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+
+        //blokovi se salju samo kad se sadrzaj promeni
+        rg::FrameData frameData;
+        frameData.m_projection = projection;
+        frameData.m_view = view;
+        frameData.m_camera_position = glm::vec4(camera.m_position, 1.0f);
+        frameData.m_time = currentFrame;
+        frameUniforms.update(frameData);
+
+        //oba svetla su u bloku, shader dana ili noci koristi svoje
+        rg::LightData lightData;
+        lightData.m_directional.m_direction = dirLight.mDirection;
+        lightData.m_directional.m_ambient = dirLight.mAmbient;
+        lightData.m_directional.m_diffuse = dirLight.mDiffuse;
+        lightData.m_directional.m_specular = dirLight.mSpecular;
+        lightData.m_spot.m_position = camera.m_position;
+        lightData.m_spot.m_direction = camera.m_front;
+        lightData.m_spot.m_cut_off = spotLight.mCutOff;
+        lightData.m_spot.m_outer_cut_off = spotLight.mOuterCutOff;
+        lightData.m_spot.m_ambient = spotLight.mAmbient;
+        lightData.m_spot.m_diffuse = spotLight.mDiffuse;
+        lightData.m_spot.m_specular = spotLight.mSpecular;
+        lightData.m_spot.m_constant = spotLight.mConstant;
+        lightData.m_spot.m_linear = spotLight.mLinear;
+        lightData.m_spot.m_quadratic = spotLight.mQuadratic;
+        lightUniforms.update(lightData);
+
+        //svetla scene se pomeraju i rasporedjuju po klasterima pre slanja poziva crtanja
+        if (clustered) {
+            for (size_t i = 0; i < nightLights.size(); i++) {
+                float angle = currentFrame * 0.5f + (float) i * 0.37f;
+                nightLights[i].m_position = nightLightOrigins[i] + glm::vec3(glm::sin(angle), 0.0f, glm::cos(angle)) * 1.5f;
+            }
+            clusteredLights.setProjection(projection, 0.1f, 100.0f, SRC_WIDTH, SRC_HEIGHT);
+            clusteredLights.update(nightLights, view);
+            clusteredLights.bind();
+        }
+
+        lodSelector.setView(camera.m_position, glm::radians(camera.m_zoom), (float) SRC_HEIGHT);
+
+        //objekti van piramide pogleda se ne salju na GPU
+        rg::Frustum frustum = rg::Frustum::fromMatrix(projection * view);
+        const rg::Frustum *cullingFrustum = frustumCulling ? &frustum : nullptr;
+
+        //BVH scene odbacuje cele objekte; pre nego sto je izgradjen svaki model se testira sam
+        if (cullingFrustum && sceneBvh.size() == sceneObjects.size()) {
+            std::fill(sceneVisible.begin(), sceneVisible.end(), 0);
+            sceneBvh.queryFrustum(frustum, [&](uint32_t object) { sceneVisible[object] = 1; });
+            size_t sceneCulled = std::count(sceneVisible.begin(), sceneVisible.end(), 0);
+            rg::FrameStats::instance().recordCulling(0, sceneCulled);
         }
         else {
-            spotShader.use();
-            spotShader.setVec3("light.m_position", camera.m_position);
-            spotShader.setVec3("light.m_direction", camera.m_front);
-            spotShader.setFloat("light.m_cutOff", spotLight.mCutOff);
-            spotShader.setFloat("light.m_outerCutOff", spotLight.mOuterCutOff);
-            spotShader.setVec3("light.m_ambient", spotLight.mAmbient);
-            spotShader.setVec3("light.m_diffuse", spotLight.mDiffuse);
-            spotShader.setVec3("light.m_specular", spotLight.mSpecular);
-            spotShader.setFloat("light.m_constant", spotLight.mConstant);
-            spotShader.setFloat("light.m_linear", spotLight.mLinear);
-            spotShader.setFloat("light.m_quadratic", spotLight.mQuadratic);
-            spotShader.setFloat("material.m_shininess", 32.0f);
-            tmpShader = &spotShader;
+            std::fill(sceneVisible.begin(), sceneVisible.end(), 1);
         }
 
+        //rezultati upita iz prethodnih frejmova; objekat ciji upit nije gotov crta se uslovno, osim drveca u
+        //instanciranom pozivu, koje se crta dok rezultat ne stigne
+        bool occlusionActive = occlusionCulling && occlusion.size() == sceneObjects.size();
+        if (occlusionActive) {
+            occlusion.collect(sceneVisible);
+        }
+        for (size_t i = 0; i < sceneObjects.size(); i++) {
+            sceneDrawn[i] = sceneVisible[i] && (!occlusionActive || occlusion.shouldDraw(i));
+            sceneConditions[i] = occlusionActive ? occlusion.condition(i) : 0;
+        }
 
-        glm::mat4 projection = glm::perspective(glm::radians(camera.m_zoom),
-                                                (float) SRC_WIDTH / (float) SRC_HEIGHT, 0.1f, 100.0f);
-        glm::mat4 view = camera.GetViewMatrix();
-        tmpShader->setMat4("projection", projection);
-        tmpShader->setMat4("view", view);
-
-        glm::vec3 modelScale = glm::vec3(1.0f);
-
-        for (unsigned int i = 0; i < 60; i++) {
-            float f = floats.at(i) * 60;
-            glm::mat4 model2 = glm::mat4(1.0f);
-            glm::vec3 pos = glm::vec3(glm::sin(glm::radians((float) i * 6))*f, 0.0f, glm::cos(glm::radians((float) i * 6))*f);
-            model2 = glm::translate(model2, pos);
-            model2 = glm::scale(model2, modelScale);
-            tmpShader->setMat4("model", model2);
-            ourModel2.Draw(*tmpShader);
+        visibleTrees.clear();
+        visibleTreeConditions.clear();
+        for (size_t i = 0; i < sceneObjects.size(); i++) {
+            if (sceneDrawn[i] && sceneObjects[i].m_model == &ourModel2) {
+                visibleTrees.push_back(sceneObjects[i].m_transform);
+                visibleTreeConditions.push_back(sceneConditions[i]);
+            }
         }
 
-        modelScale = glm::vec3(3.0f);
+        //G-buffer deli dubinu sa MSAA framebuffer-om, koja je vec obrisana; alfa kanal nosi spekularni intenzitet,
+        //pa se mesanje iskljucuje
+        if (deferredShading) {
+            glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glDisable(GL_BLEND);
+        }
 
-        glm::mat4 model = glm::mat4(1.0f);
-        glm::vec3 pos = glm::vec3(0.0f, -5.4f, 0.0f);
-        model = glm::translate(model, pos);
-        //model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = glm::scale(model, modelScale);
-        tmpShader->setMat4("model", model);
-        ourModel.Draw(*tmpShader);
+        //svi pozivi frejma idu kroz red, koji ih grupise po shader-u, materijalu i VAO-u
+        //scena se predaje redu jednom po frejmu, pa se odbacivanje, izbor nivoa detalja, slanje instanci i upis
+        //indirektnih komandi ne ponavljaju za prolaz samo dubine; on iste pakete crta varijantama depthShaders
+        sceneShaders.setIgnoredFeatures(depthPrepass ? rg::SHADER_ALPHA_TEST | rg::SHADER_ALPHA_TO_COVERAGE : 0u);
+        uint32_t instancedFeatures = surfaceFeatures | rg::SHADER_INSTANCED;
+        //indirektni put cita model matricu iz atributa instance i za pojedinacne objekte
+        uint32_t objectFeatures = renderQueue.indirectActive() ? instancedFeatures : surfaceFeatures;
+        renderQueue.begin(camera.m_position);
+
+        //drvece: jedan instancirani poziv po mesh-u i nivou detalja, ili poziv po drvetu radi poredjenja
+        if (instancing) {
+            ourModel2.SubmitInstanced(renderQueue, sceneShaders, instancedFeatures, visibleTrees.data(), visibleTrees.size(), lodSelector, cullingFrustum);
+        }
+        else {
+            for (size_t i = 0; i < visibleTrees.size(); i++) {
+                renderQueue.setCondition(visibleTreeConditions[i]);
+                ourModel2.Submit(renderQueue, sceneShaders, objectFeatures, visibleTrees[i], lodSelector, cullingFrustum);
+            }
+        }
 
-        modelScale = glm::vec3(0.8f);
+        for (size_t i = 0; i < sceneObjects.size(); i++) {
+            if (sceneDrawn[i] && sceneObjects[i].m_model != &ourModel2) {
+                renderQueue.setCondition(sceneConditions[i]);
+                sceneObjects[i].m_model->Submit(renderQueue, sceneShaders, objectFeatures, sceneObjects[i].m_transform, lodSelector, cullingFrustum);
+            }
+        }
+        renderQueue.setCondition(0);
+
+        //alfa test se radi samo u prolazu dubine; prolaz osvetljenja onda nema discard, pa zadrzava rani test
+        //dubine, a sa GL_EQUAL racuna svetlo samo za uzorke koji su stvarno vidljivi
+        //alpha-to-coverage vazi samo u prolazu koji radi alfa test; na forward putu se ukljucuje i alpha-to-one,
+        //jer bi mesanje inace koristilo alfu pokrivenosti kao providnost (G-buffer se crta bez mesanja)
+        if (alphaToCoverage) {
+            glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+            if (!deferredShading && !depthPrepass) {
+                glEnable(GL_SAMPLE_ALPHA_TO_ONE);
+            }
+        }
 
-        model = glm::mat4(1.0f);
-        pos = glm::vec3(2.0f, 1.1f, 15.0f);
-        model = glm::translate(model, pos);
-        model = glm::rotate(model, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::scale(model, modelScale);
-        tmpShader->setMat4("model", model);
-        ourModel3.Draw(*tmpShader);
+        if (depthPrepass) {
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            gpuTimer.begin("dubina");
+            sampleCounter.begin("dubina");
+            renderQueue.submit(&depthShaders);
+            sampleCounter.end();
+            gpuTimer.end();
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glDepthFunc(GL_EQUAL);
+            glDepthMask(GL_FALSE);
+            glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+        }
 
-        modelScale = glm::vec3(0.8f);
+        const char *scenePass = deferredShading ? "G-buffer" : "forward";
+        gpuTimer.begin(scenePass);
+        sampleCounter.begin(scenePass);
+        renderQueue.submit();
+        sampleCounter.end();
+        gpuTimer.end();
 
-        model = glm::mat4(1.0f);
-        pos = glm::vec3(-10.0f, 1.1f, 1.0f);
-        model = glm::translate(model, pos);
-        //model = glm::rotate(model, glm::radians(-110.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::scale(model, modelScale);
-        tmpShader->setMat4("model", model);
-        ourModel3.Draw(*tmpShader);
+        if (depthPrepass) {
+            glDepthFunc(GL_LESS);
+            glDepthMask(GL_TRUE);
+        }
+        glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+        glDisable(GL_SAMPLE_ALPHA_TO_ONE);
+
+        //kvadri se testiraju u framebuffer-u scene (MSAA ili G-buffer), nad dubinom koju je scena upravo upisala;
+        //i zaklonjeni objekti dobijaju upit, da bi se ponovo pojavili kad postanu vidljivi
+        if (occlusionActive) {
+            gpuTimer.begin("upiti");
+            occlusion.issue(occlusionShader, sceneVisible, camera.m_position);
+            gpuTimer.end();
+        }
 
+        //osvetljenje jednom po pikselu preko celog ekrana, bez testa dubine; svetla klastera su vec vezana
+        if (deferredShading) {
+            glEnable(GL_BLEND);
+            glBindFramebuffer(GL_FRAMEBUFFER, lightingFramebuffer);
+            glDisable(GL_DEPTH_TEST);
+            gpuTimer.begin("osvetljenje");
+            Shader &lightingShader = deferredLightingShaders.get(lightFeatures);
+            lightingShader.use();
+            lightingShader.setMat4(uniforms::INVERSE_VIEW_PROJECTION, glm::inverse(projection * view));
+            glActiveTexture(GL_TEXTURE10);
+            glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, gAlbedoSpecular);
+            glActiveTexture(GL_TEXTURE11);
+            glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, gNormal);
+            glActiveTexture(GL_TEXTURE12);
+            glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, depthStencilMultiSampled);
+            glActiveTexture(GL_TEXTURE0);
+            glBindVertexArray(quadVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            gpuTimer.end();
+            glEnable(GL_DEPTH_TEST);
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        }
+
+        gpuTimer.begin("nebo i AA");
         //std::cout << camera.m_position.x << " " << camera.m_position.z << "\n";
 
         glDepthFunc(GL_LEQUAL);
         skyboxShader.use();
         view = glm::mat4(glm::mat3(camera.GetViewMatrix())); // remove translation from the view matrix
-        skyboxShader.setMat4("view", view);
-        skyboxShader.setMat4("projection", projection);
+        skyboxShader.setMat4(uniforms::VIEW, view);
+        skyboxShader.setMat4(uniforms::PROJECTION, projection);
         glBindVertexArray(skyboxVAO);
         glActiveTexture(GL_TEXTURE0);
         if (day) {
@@ -412,19 +788,28 @@ int main() {
         glDisable(GL_DEPTH_TEST);
 
         screenShader.use();
-        screenShader.setFloat("nightVision", nightVision);
+        screenShader.setFloat(uniforms::NIGHT_VISION, nightVision);
         glBindVertexArray(quadVAO);
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, textureColorBufferMultiSampled);
         glDrawArrays(GL_TRIANGLES, 0, 6);
         glEnable(GL_DEPTH_TEST);
+        gpuTimer.end();
 
         //glfw: zameni buffer-e i proveri ulaze (pritisnuti dugmici, pomeren mis)
         glfwSwapBuffers(window);
         glfwPollEvents();
+
+        rg::FrameStats::instance().endFrame(glfwGetTime());
+        gpuTimer.endFrame(glfwGetTime());
+        sampleCounter.endFrame(glfwGetTime());
+
+        if (firstFrame) {
+            std::cout << "Prvi frejm posle " << glfwGetTime() * 1000.0 << " ms" << "\n";
+            firstFrame = false;
+        }
     }
 
-    glfwTerminate();
     return 0;
 }
 
@@ -501,27 +886,76 @@ void keyCallBack(GLFWwindow *window, int key, int scancode, int action, int mods
     if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS) {
         day = !day;
     }
+    if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS) {
+        instancing = !instancing;
+        std::cout << "Instanciranje " << (instancing ? "ukljuceno" : "iskljuceno") << "\n";
+    }
+    if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS) {
+        frustumCulling = !frustumCulling;
+        std::cout << "Frustum culling " << (frustumCulling ? "ukljucen" : "iskljucen") << "\n";
+    }
+    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) {
+        renderQueue.m_sorting = !renderQueue.m_sorting;
+        std::cout << "Sortiranje poziva crtanja " << (renderQueue.m_sorting ? "ukljuceno" : "iskljuceno") << "\n";
+    }
+    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS) {
+        renderQueue.m_indirect = !renderQueue.m_indirect;
+        if (rg::MultiDrawIndirect::isSupported())
+            std::cout << "Indirektno crtanje " << (renderQueue.m_indirect ? "ukljuceno" : "iskljuceno") << "\n";
+        else
+            std::cout << "Indirektno crtanje nije podrzano, koristi se GL 3.3 put" << "\n";
+    }
+    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS) {
+        clusteredLighting = !clusteredLighting;
+        std::cout << "Klasterovana svetla " << (clusteredLighting ? "ukljucena" : "iskljucena") << "\n";
+    }
+    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS) {
+        deferredShading = !deferredShading;
+        std::cout << (deferredShading ? "Odlozeno osvetljenje (G-buffer)" : "Forward osvetljenje") << "\n";
+    }
+    if (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS) {
+        depthPrepass = !depthPrepass;
+        std::cout << "Prolaz samo dubine " << (depthPrepass ? "ukljucen" : "iskljucen") << "\n";
+    }
+    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS) {
+        alphaToCoverage = !alphaToCoverage;
+        std::cout << "Alpha-to-coverage " << (alphaToCoverage ? "ukljucen" : "iskljucen, lisce koristi alfa test") << "\n";
+    }
+    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS) {
+        occlusionCulling = !occlusionCulling;
+        std::cout << "Occlusion culling " << (occlusionCulling ? "ukljucen" : "iskljucen") << "\n";
+    }
+    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS) {
+        lodSelector.m_enabled = !lodSelector.m_enabled;
+        std::cout << "LOD " << (lodSelector.m_enabled ? "ukljucen" : "iskljucen") << "\n";
+    }
+    if (glfwGetKey(window, GLFW_KEY_LEFT_BRACKET) == GLFW_PRESS) {
+        lodSelector.m_pixel_error = std::max(lodSelector.m_pixel_error * 0.5f, 0.125f);
+        std::cout << "LOD greska " << lodSelector.m_pixel_error << " px\n";
+    }
+    if (glfwGetKey(window, GLFW_KEY_RIGHT_BRACKET) == GLFW_PRESS) {
+        lodSelector.m_pixel_error = std::min(lodSelector.m_pixel_error * 2.0f, 64.0f);
+        std::cout << "LOD greska " << lodSelector.m_pixel_error << " px\n";
+    }
 }
 
-unsigned int loadCubemap(std::vector<std::string> faces)
+unsigned int loadCubemap(const std::vector<std::shared_future<rg::Image>>& faces)
 {
     unsigned int textureID;
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
-    int width, height, nrChannels;
+    //slike su vec dekodirane (ili se dekodiraju) na radnim nitima, ovde se samo salju na GPU
     for (unsigned int i = 0; i < faces.size(); i++)
     {
-        unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-        if (data)
+        const rg::Image& image = faces[i].get();
+        if (image.isValid())
         {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, image.m_width, image.m_height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.m_data.get());
         }
         else
         {
-            std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
+            std::cout << "Cubemap texture failed to load at path: " << image.m_path << std::endl;
         }
     }
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);